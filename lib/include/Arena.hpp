@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_ARENA_HPP
+#define DECISIONTREE_ARENA_HPP
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "Utils.hpp"
+
+/**
+ * Monotonic arena handing out stable, index-addressed slots.
+ *
+ * Storage grows in segments of doubling size, so elements never move once
+ * they are constructed and an index resolves to its segment with a single bit
+ * scan. Elements are only destroyed together with the arena. Allocation is
+ * thread-safe; reading an element is safe once its index has been handed to
+ * the reading thread.
+ */
+template<typename T>
+class MonotonicArena {
+  public:
+    MonotonicArena() = default;
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+    MonotonicArena(MonotonicArena&& other) noexcept :
+        segments_(std::move(other.segments_)), size_(other.size_) {
+      other.size_ = 0;
+    }
+    MonotonicArena& operator=(MonotonicArena&& other) noexcept {
+      if (this != &other) {
+        clear();
+        segments_ = std::move(other.segments_);
+        size_ = other.size_;
+        other.size_ = 0;
+      }
+      return *this;
+    }
+    ~MonotonicArena() { clear(); }
+
+    template<typename... Args>
+      Idx emplace(Args&&... args) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Idx index = size_;
+        const auto [segment, offset] = locate(index);
+        if (!segments_[segment])
+          segments_[segment] = std::make_unique<Slot[]>(segmentSize(segment));
+        new (segments_[segment][offset].bytes) T(std::forward<Args>(args)...);
+        ++size_;
+        return index;
+      }
+
+    inline const T& operator[](Idx index) const {
+      const auto [segment, offset] = locate(index);
+      return *std::launder(reinterpret_cast<const T*>(segments_[segment][offset].bytes));
+    }
+
+    inline T& operator[](Idx index) {
+      const auto [segment, offset] = locate(index);
+      return *std::launder(reinterpret_cast<T*>(segments_[segment][offset].bytes));
+    }
+
+    inline size_t size() const { return size_; }
+
+  private:
+    static constexpr int kBaseBits = 6;
+    static constexpr int kMaxSegments = 32 - kBaseBits;
+
+    struct Slot {
+      alignas(T) unsigned char bytes[sizeof(T)];
+    };
+
+    static inline size_t segmentSize(int segment) { return size_t(1) << (segment + kBaseBits); }
+
+    static inline std::pair<int, size_t> locate(Idx index) {
+      const uint64_t biased = uint64_t(index) + (uint64_t(1) << kBaseBits);
+      const int msb = 63 - __builtin_clzll(biased);
+      return {msb - kBaseBits, biased - (uint64_t(1) << msb)};
+    }
+
+    void clear() {
+      for (Idx i = 0; i < size_; i++)
+        (*this)[i].~T();
+      size_ = 0;
+    }
+
+    std::array<std::unique_ptr<Slot[]>, kMaxSegments> segments_ = {};
+    Idx size_ = 0;
+    std::mutex mutex_ = {};
+};
+
+/**
+ * Lease of a reusable, thread-local std::vector.
+ *
+ * The vector goes back to the calling thread's pool on destruction with its
+ * capacity intact, so split search stops allocating once each worker thread
+ * has handled its largest node.
+ */
+template<typename T>
+class ScratchBuffer {
+  public:
+    ScratchBuffer() : buffer_(acquire()) {}
+    explicit ScratchBuffer(size_t n, const T& value = T()) : buffer_(acquire()) {
+      buffer_.assign(n, value);
+    }
+    ScratchBuffer(const ScratchBuffer&) = delete;
+    ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+    ~ScratchBuffer() {
+      buffer_.clear();
+      pool().push_back(std::move(buffer_));
+    }
+
+    inline std::vector<T>& operator*() { return buffer_; }
+    inline std::vector<T>* operator->() { return &buffer_; }
+
+  private:
+    static std::vector<std::vector<T>>& pool() {
+      thread_local std::vector<std::vector<T>> buffers;
+      return buffers;
+    }
+
+    static std::vector<T> acquire() {
+      auto& buffers = pool();
+      if (buffers.empty())
+        return {};
+      std::vector<T> buffer = std::move(buffers.back());
+      buffers.pop_back();
+      return buffer;
+    }
+
+    std::vector<T> buffer_;
+};
+
+#endif //DECISIONTREE_ARENA_HPP
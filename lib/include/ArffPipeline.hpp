@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_ARFFPIPELINE_HPP
+#define DECISIONTREE_ARFFPIPELINE_HPP
+
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Utils.hpp"
+
+/**
+ * Staged reader for the data section of one or more ARFF files at once.
+ *
+ * Every file has an I/O stage that reads it in large blocks cut at line
+ * ends. The blocks of all files go through one bounded queue to a shared
+ * set of workers that split them into fields and convert these to typed
+ * rows. Each file's rows go through a second bounded queue to its append
+ * stage, which puts the blocks back in file order, so the rows come out
+ * in the order of the file. The I/O stage stays at most a fixed number of
+ * blocks ahead of the append stage, which bounds the memory in flight.
+ *
+ * The workers look categories up in a copy of the codes declared in the
+ * header. Values missing from it are encoded by the append stage, in file
+ * order, so the codes appended to the metadata do not depend on timing.
+ */
+class ArffPipeline {
+  public:
+    struct Input {
+      std::string filename;
+      std::streamoff dataStart; // offset of the line after @DATA
+      VecI fieldOf;             // field of the file holding each attribute
+      MetaData* meta;
+      Data* data;
+    };
+
+    explicit ArffPipeline(size_t workers = std::thread::hardware_concurrency(), size_t blockSize = 1 << 22);
+
+    /**
+     * Appends the rows of every input to its data. Throws the first error
+     * raised by any of the stages.
+     */
+    void run(const std::vector<Input>& inputs) const;
+
+  private:
+    const size_t workers_;
+    const size_t blockSize_;
+};
+
+#endif //DECISIONTREE_ARFFPIPELINE_HPP
@@ -13,20 +13,43 @@
 #include "DecisionTree.hpp"
 #include "Calculations.hpp"
 #include "DataReader.hpp"
+#include "Predictor.hpp"
 #include "TreeTest.hpp"
 
 class Bagging {
   public:
     Bagging() = delete;
-    explicit Bagging(const DataReader& dr, const int ensembleSize, uint seed = 1234);
+    // With params.extraTrees, an ensemble of extremely randomized trees
+    explicit Bagging(const DataReader& dr, const int ensembleSize, uint seed = 1234, const TreeParams& params = TreeParams());
 
     void test() const;
 
     inline Data testData() { return dr_.testData(); }
+    inline const std::vector<DecisionTree>& learners() const { return learners_; }
+    // Trees of the learners, e.g. for a Predictor, CompactForest or CodeGen
+    std::vector<const Tree*> trees() const;
+
+    /**
+     * Impurity decrease and split count per feature, summed over the
+     * learners. The per-node sample counts are left empty, they are found in
+     * the statistics of every learner.
+     */
+    TreeStats stats() const;
+
+    /**
+     * Normalised impurity decrease per feature, averaged over the learners.
+     */
+    std::vector<double> featureImportance() const;
+
+    /**
+     * Decrease in accuracy on data when a feature is shuffled.
+     */
+    std::vector<double> permutationImportance(const Data& data, int repeats = 5, uint seed = 1234) const;
 
   private:
     DataReader dr_;
     int ensembleSize_;
+    TreeParams params_;
     std::vector<DecisionTree> learners_;
     std::mt19937_64 random_number_generator;
 
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_BOUNDEDQUEUE_HPP
+#define DECISIONTREE_BOUNDEDQUEUE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+/**
+ * Bounded multi-producer multi-consumer queue without locks [Vyu10].
+ *
+ * Every cell carries a sequence number that tells producers and consumers
+ * whether it is free or filled for their position, so a push or pop is a
+ * single compare-and-swap on the shared position in the common case. The
+ * capacity is rounded up to a power of two.
+ *
+ * The blocking push and pop back off from spinning to yielding to short
+ * sleeps, and give up once abort is set.
+ *
+ * [Vyu10] Vyukov, D. Bounded MPMC queue. 1024cores.net
+ */
+template<typename T>
+class BoundedQueue {
+  public:
+    explicit BoundedQueue(size_t capacity) :
+        capacity_(roundUp(capacity)), cells_(new Cell[capacity_]), enqueuePos_(0), dequeuePos_(0) {
+      for (size_t i = 0; i < capacity_; i++)
+        cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool tryPush(T& value) {
+      size_t pos = enqueuePos_.load(std::memory_order_relaxed);
+      while (true) {
+        Cell& cell = cells_[pos & (capacity_ - 1)];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = (intptr_t) sequence - (intptr_t) pos;
+        if (diff == 0) {
+          if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            cell.value = std::move(value);
+            cell.sequence.store(pos + 1, std::memory_order_release);
+            return true;
+          }
+        } else if (diff < 0) {
+          return false; // full
+        } else {
+          pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    bool tryPop(T& value) {
+      size_t pos = dequeuePos_.load(std::memory_order_relaxed);
+      while (true) {
+        Cell& cell = cells_[pos & (capacity_ - 1)];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const intptr_t diff = (intptr_t) sequence - (intptr_t) (pos + 1);
+        if (diff == 0) {
+          if (dequeuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+            value = std::move(cell.value);
+            cell.sequence.store(pos + capacity_, std::memory_order_release);
+            return true;
+          }
+        } else if (diff < 0) {
+          return false; // empty
+        } else {
+          pos = dequeuePos_.load(std::memory_order_relaxed);
+        }
+      }
+    }
+
+    /**
+     * Returns false when abort was set before value could be pushed.
+     */
+    bool push(T& value, const std::atomic<bool>& abort) {
+      return waitFor([&]() { return tryPush(value); }, abort);
+    }
+
+    /**
+     * Returns false when abort was set before a value could be popped.
+     */
+    bool pop(T& value, const std::atomic<bool>& abort) {
+      return waitFor([&]() { return tryPop(value); }, abort);
+    }
+
+    /**
+     * Calls attempt until it succeeds or abort is set, backing off in between.
+     */
+    template<typename F>
+      static bool waitFor(F&& attempt, const std::atomic<bool>& abort) {
+        for (int round = 0; !attempt(); round++) {
+          if (abort.load(std::memory_order_relaxed))
+            return false;
+          if (round < 64)
+            continue;
+          else if (round < 128)
+            std::this_thread::yield();
+          else
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+        }
+        return true;
+      }
+
+  private:
+    struct Cell {
+      std::atomic<size_t> sequence{0};
+      T value{};
+    };
+
+    static size_t roundUp(size_t n) {
+      size_t capacity = 2;
+      while (capacity < n)
+        capacity <<= 1;
+      return capacity;
+    }
+
+    const size_t capacity_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(64) std::atomic<size_t> enqueuePos_;
+    alignas(64) std::atomic<size_t> dequeuePos_;
+};
+
+#endif //DECISIONTREE_BOUNDEDQUEUE_HPP
@@ -12,25 +12,78 @@
 #include <string>
 #include <unordered_map>
 #include <boost/timer/timer.hpp>
+#include "ColumnStore.hpp"
 #include "Question.hpp"
 #include "Utils.hpp"
 
 using ClassCounter = std::unordered_map<int, int>;
 
+using ClassTally = std::vector<int>;
+
 namespace Calculations {
 
-std::tuple<Data, Data> partition(const Data &data, const Question &q);
+std::tuple<RowView, RowView> partition(const ColumnStore &store, RowView rows, const Question &q);
 
 const double gini(const ClassCounter& counts, double N);
 
-std::tuple<const double, const Question> find_best_split(const Data &rows, const MetaData &meta);
+const double gini(const ClassTally& tally, double N);
+
+// approximate takes the numeric thresholds of dense features from the quantile
+// sketches of the store.
+std::tuple<const double, const Question> find_best_split(const ColumnStore &store, RowView rows, bool approximate = false);
+
+// multiplicity, when given, holds the number of times each row of the store
+// occurs in rows; the rows are then read in presorted order.
+std::tuple<int, double> determine_best_threshold_numeric(const ColumnStore &store, RowView rows, int col, const int *multiplicity = nullptr);
+
+// Stratified sample of about size of rows, drawn without replacement: every
+// class present gets its share of the sample, and at least one row.
+void stratified_sample(const ColumnStore &store, RowView rows, size_t size, uint64_t seed, VecIdx &sample);
+
+// Question on the same feature as q, with its threshold or category subset
+// searched again on rows, and its gain there.
+std::tuple<const double, const Question> refine_split(const ColumnStore &store, RowView rows, const Question &q);
+
+// Extremely randomized split [GEW06]: maxFeatures features drawn at random,
+// all when 0, each get one threshold drawn uniformly between their minimum and
+// maximum in the node, or a random subset of the categories present, scored
+// with a single counting pass. The draws depend on seed only.
+//
+// [GEW06] Geurts, P., Ernst, D., and Wehenkel, L. Extremely randomized trees.
+//         Machine Learning 63(1), 2006.
+std::tuple<const double, const Question> find_random_split(const ColumnStore &store, RowView rows, uint64_t seed, int maxFeatures = 0);
 
-std::tuple<int, double> determine_best_threshold_numeric(const Data &data, int col);
+// Best numeric threshold among the sketch values of col, from one pass that
+// counts the classes per sketch bin.
+std::tuple<int, double> determine_best_threshold_sketch(const ColumnStore &store, RowView rows, int col);
 
-std::tuple<int, double> determine_best_threshold_cat(const Data &data, int col);
+// Best numeric threshold among cuts, given the class counts of the bins
+// between them: bin b holds the values in [cuts[b-1], cuts[b]), with
+// numClasses counts per bin and cuts.size() + 1 bins.
+std::tuple<int, double> determine_best_threshold_binned(const int *bins, const VecI &cuts, int numClasses);
+
+// Best numeric threshold over all sparse features of the store, as
+// (feature, threshold, loss); feature is -1 when no sparse feature varies in
+// the node. tally holds the class counts of rows.
+std::tuple<int, int, double> determine_best_threshold_sparse(const ColumnStore &store, RowView rows, const ClassTally &tally, const int *multiplicity = nullptr);
+
+// Best numeric threshold over the members of bundle b of the store, as
+// (feature, threshold, loss), from the non-zero entries of the bundle in the
+// node; feature is -1 when no member varies in the node. tally holds the
+// class counts of rows.
+std::tuple<int, int, double> determine_best_threshold_bundle(const ColumnStore &store, RowView rows, size_t b, const ClassTally &tally, const int *multiplicity = nullptr);
+
+double determine_best_subset_cat(const ColumnStore &store, RowView rows, int col, VecI &subset);
+
+// Same search on class counts given per category, numClasses counts each.
+double determine_best_subset_counts(const int *countersCat, int numCategories, int numClasses, VecI &subset);
 
 const ClassCounter classCounts(const Data &data);
 
+const ClassCounter classCounts(const ColumnStore &store, RowView rows);
+
+void classTally(const ColumnStore &store, RowView rows, ClassTally &tally);
+
 } // namespace Calculations
 
 #endif //DECISIONTREE_CALCULATIONS_HPP
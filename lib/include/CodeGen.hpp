@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_CODEGEN_HPP
+#define DECISIONTREE_CODEGEN_HPP
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Predictor.hpp"
+#include "Tree.hpp"
+
+class DecisionTree;
+class Bagging;
+
+/**
+ * Exporter of trained models to specialised C++ source.
+ *
+ * Every tree becomes a function of nested if-else statements with the tested
+ * columns, thresholds and category bitsets baked in as immediates. The
+ * generated translation unit exposes a small C interface:
+ *
+ *   int  cart_num_classes();
+ *   int  cart_predict(const int* row);
+ *   void cart_predict_proba(const int* row, double* probabilities);
+ *
+ * where row points to the attribute values of one example, in the column
+ * order of the training data.
+ */
+class CodeGen {
+  public:
+    CodeGen() = delete;
+    explicit CodeGen(const DecisionTree& tree);
+    explicit CodeGen(const Bagging& bagging, Predictor::Voting voting = Predictor::Voting::Majority);
+    CodeGen(const std::vector<const Tree*>& trees, int numClasses, Predictor::Voting voting);
+
+    void write(std::ostream& out) const;
+    void write(const std::string& filename) const;
+
+  private:
+    void writeTree(std::ostream& out, const Tree& tree, NodeId id, int depth,
+                   std::vector<std::pair<const Tree*, const Node*>>& leaves) const;
+
+    std::vector<const Tree*> trees_;
+    int numClasses_;
+    Predictor::Voting voting_;
+};
+
+/**
+ * Model compiled from CodeGen output into a shared object and loaded with
+ * dlopen.
+ *
+ * The compiler is taken from the CXX environment variable and defaults to
+ * c++. It is run directly, without a shell, so CXX names a single program
+ * and paths need no quoting. The object is unloaded when the model is
+ * destroyed.
+ */
+class CompiledModel {
+  public:
+    CompiledModel() = delete;
+    explicit CompiledModel(const std::string& sharedObject);
+    CompiledModel(const CompiledModel&) = delete;
+    CompiledModel& operator=(const CompiledModel&) = delete;
+    CompiledModel(CompiledModel&& other) noexcept;
+    ~CompiledModel();
+
+    static CompiledModel compile(const CodeGen& model, const std::string& basename);
+
+    inline int predict(const VecI& row) const { return predict_(row.data()); }
+    inline void predictProba(const VecI& row, double* probabilities) const { predictProba_(row.data(), probabilities); }
+    inline int numClasses() const { return numClasses_(); }
+
+  private:
+    void* handle_;
+    int (*numClasses_)();
+    int (*predict_)(const int*);
+    void (*predictProba_)(const int*, double*);
+};
+
+#endif //DECISIONTREE_CODEGEN_HPP
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_COLUMNSTORE_HPP
+#define DECISIONTREE_COLUMNSTORE_HPP
+
+#include <vector>
+#include "LeafProbabilities.hpp"
+#include "QuantileSketch.hpp"
+#include "Utils.hpp"
+
+/**
+ * Sparse matrix in compressed sparse row (CSR) form: the non-zero entries of
+ * row r are feature[rowStart[r]..rowStart[r+1]) and the matching values,
+ * sorted on feature. Entries that are absent are zero.
+ */
+struct SparseMatrix {
+  std::vector<size_t> rowStart = {0};
+  VecIdx feature = {};
+  VecI value = {};
+
+  inline size_t numRows() const { return rowStart.size() - 1; }
+  inline size_t nonZeros() const { return value.size(); }
+};
+
+/**
+ * Mutually exclusive attributes packed into one column: in every row at most
+ * one member is non-zero. Member j takes the values (offsets[j],
+ * offsets[j+1]] of the column, value x of the member being stored as
+ * offsets[j] + x; rows where all members are zero hold 0.
+ */
+struct FeatureBundle {
+  VecI members = {};       // ascending
+  VecI offsets = {};       // members.size() + 1 of them, ascending
+  VecI column = {};
+  VecIdx nonZeroRows = {}; // rows with a non-zero member, sorted on column
+};
+
+/**
+ * Column-major copy of a training set, shared by every tree learned from it.
+ *
+ * Besides one contiguous vector per attribute and one for the class labels,
+ * the store keeps for every numeric attribute the row indices sorted on that
+ * attribute. Large nodes read their sort order from this index instead of
+ * sorting, so the cost of sorting is paid once per data set rather than once
+ * per node, fold and configuration.
+ *
+ * Numeric attributes can also be stored sparsely, for data sets with many
+ * mostly-zero features. Their non-zero entries are kept twice: row-major
+ * (CSR), so that a node can visit only the non-zeros of its own rows, and
+ * column-major (CSC) with every column sorted on value, which takes the place
+ * of the presorted index. column() is empty for sparse attributes; value()
+ * works for both layouts.
+ *
+ * On NUMA machines the dense attributes are sharded over the nodes in
+ * contiguous blocks. The column and presorted index of an attribute are
+ * built by the workers of the node that owns it (see NumaPools), so their
+ * pages are allocated there, and split search scans an attribute on that
+ * same node.
+ *
+ * With several class columns, the store learns on their joint classes and
+ * outputs() maps these back to the class of every output.
+ *
+ * For very large data sets, buildSketches() summarises every dense numeric
+ * attribute with a QuantileSketch, whose values serve as split candidates
+ * near the root (see TreeParams::sketchDepth).
+ *
+ * For wide data sets, reduceFeatures() takes constant and duplicate
+ * attributes out of split search, and packs mostly-zero attributes that are
+ * never non-zero together into FeatureBundles, as in LightGBM's exclusive
+ * feature bundling. The attributes themselves stay in the store, so
+ * questions and importances keep referring to the original attributes.
+ */
+class ColumnStore {
+  public:
+    ColumnStore() = delete;
+    ColumnStore(const Data& data, const MetaData& meta);
+    // One column per attribute in meta, the class labels last
+    ColumnStore(const MetaData& meta, std::vector<VecI> columns);
+    // Sparse numeric attributes only
+    ColumnStore(const MetaData& meta, SparseMatrix matrix, VecI labels);
+    // The last numOutputs columns are class columns, learned jointly: every
+    // combination of their classes seen is one class of the store
+    ColumnStore(const MetaData& meta, std::vector<VecI> columns, size_t numOutputs);
+
+    inline size_t numRows() const { return labels_.size(); }
+    inline int numFeatures() const { return columns_.size(); }
+    inline int numClasses() const { return numClasses_; }
+    inline const OutputLayout& outputs() const { return outputs_; }
+
+    inline const VecI& column(int f) const { return columns_[f]; }
+    inline const VecI& labels() const { return labels_; }
+    inline bool isNumeric(int f) const { return numeric_[f]; }
+    inline bool isSparse(int f) const { return sparse_[f]; }
+    inline bool hasSparse() const { return !csc_.colStart.empty(); }
+    inline int numCategories(int f) const { return numCategories_[f]; }
+    inline const MetaData& meta() const { return meta_; }
+
+    /**
+     * Indices of all rows, sorted on numeric attribute f.
+     */
+    inline const VecIdx& sortedRows(int f) const { return sorted_[f]; }
+
+    /**
+     * NUMA node holding the column of attribute f.
+     */
+    inline int columnNode(int f) const { return (int64_t) f * numNodes_ / std::max<int>(1, columns_.size()); }
+
+    /**
+     * Value of attribute f in row r, whatever its layout.
+     */
+    int value(int f, Idx r) const;
+
+    /**
+     * Non-zero entries of the sparse attributes, by row.
+     */
+    inline const SparseMatrix& sparseRows() const { return csr_; }
+
+    /**
+     * Non-zero entries of sparse attribute f, sorted on value, as the range
+     * [begin, end) into sparseColumnRows() and sparseColumnValues().
+     */
+    inline size_t sparseColumnBegin(int f) const { return csc_.colStart[f]; }
+    inline size_t sparseColumnEnd(int f) const { return csc_.colStart[f + 1]; }
+    inline const VecIdx& sparseColumnRows() const { return csc_.row; }
+    inline const VecI& sparseColumnValues() const { return csc_.value; }
+
+    /**
+     * Builds a quantile sketch with error epsilon, at least 1e-4, for every
+     * dense numeric attribute, in one parallel pass over parts of the columns
+     * whose sketches are then merged, and bins the rows between its values.
+     */
+    void buildSketches(double epsilon);
+
+    inline bool hasSketches() const { return !sketches_.empty(); }
+    inline const QuantileSketch& sketch(int f) const { return sketches_[f]; }
+
+    /**
+     * Values of the sketch of attribute f in ascending order.
+     */
+    inline const VecI& sketchValues(int f) const { return sketchValues_[f]; }
+
+    /**
+     * Bin of every row for attribute f: bin b holds the rows whose value lies
+     * in [sketchValues(f)[b-1], sketchValues(f)[b]).
+     */
+    inline const std::vector<uint16_t>& sketchBins(int f) const { return sketchBins_[f]; }
+
+    /**
+     * Marks constant attributes and copies of an earlier attribute as
+     * redundant, and bundles the remaining dense numeric attributes that are
+     * non-negative and at most half non-zero, greedily, into bundles of
+     * mutually exclusive attributes.
+     */
+    void reduceFeatures();
+
+    /**
+     * Attributes that split search scans one by one: all of them, but for
+     * those that reduceFeatures() found redundant or bundled.
+     */
+    inline const VecI& features() const { return features_; }
+    inline bool isRedundant(int f) const { return redundant_[f]; }
+
+    inline size_t numBundles() const { return bundles_.size(); }
+    inline const FeatureBundle& bundle(size_t b) const { return bundles_[b]; }
+
+  private:
+    struct SparseColumns {
+      std::vector<size_t> colStart = {};
+      VecIdx row = {};
+      VecI value = {};
+    };
+
+    void index(bool placed);
+
+    MetaData meta_;
+    std::vector<VecI> columns_;
+    VecI labels_;
+    std::vector<bool> numeric_;
+    std::vector<bool> sparse_;
+    VecI numCategories_;
+    std::vector<VecIdx> sorted_;
+    SparseMatrix csr_;
+    SparseColumns csc_;
+    std::vector<QuantileSketch> sketches_;
+    std::vector<VecI> sketchValues_;
+    std::vector<std::vector<uint16_t>> sketchBins_;
+    int numClasses_;
+    OutputLayout outputs_;
+    int numNodes_;
+    VecI features_;
+    std::vector<bool> redundant_;
+    std::vector<FeatureBundle> bundles_;
+};
+
+#endif //DECISIONTREE_COLUMNSTORE_HPP
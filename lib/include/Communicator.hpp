@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_COMMUNICATOR_HPP
+#define DECISIONTREE_COMMUNICATOR_HPP
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/**
+ * Collective operations between the worker processes of one training run.
+ *
+ * The workers form a ring: each connects to the next rank and accepts a
+ * connection from the previous one, over Unix domain sockets or TCP. The
+ * address is "unix:<prefix>", where rank r listens on <prefix>.<r>, or
+ * "tcp:<host>:<port>", where rank r listens on port + r.
+ *
+ * allReduce is the ring algorithm [PY09]: a reduce-scatter followed by an
+ * all-gather, each of size - 1 steps in which every rank sends one chunk of
+ * the buffer to the next rank while it receives one from the previous. Every
+ * rank sends and receives 2 (size - 1) / size of the buffer, whatever the
+ * number of workers. Integer sums are exact, so all ranks end with the same
+ * values, whatever the order in which they were added.
+ *
+ * A default constructed communicator is a single process; its collectives
+ * leave the buffer as is.
+ *
+ * [PY09] Patarasuk, P., and Yuan, X. Bandwidth optimal all-reduce algorithms
+ *        for clusters of workstations. J. Parallel Distrib. Comput. 69(2), 2009.
+ */
+class Communicator {
+  public:
+    enum class Op { Sum, Min, Max };
+
+    Communicator();
+    // Blocks until the ring is connected; peers that are not listening yet are
+    // retried for timeoutSeconds.
+    Communicator(int rank, int size, const std::string& address, int timeoutSeconds = 30);
+    Communicator(const Communicator&) = delete;
+    Communicator& operator=(const Communicator&) = delete;
+    ~Communicator();
+
+    inline int rank() const { return rank_; }
+    inline int size() const { return size_; }
+
+    // Every rank must call it with the same number of values
+    template<typename T>
+    void allReduce(std::vector<T>& values, Op op = Op::Sum) {
+      if (size_ == 1 || values.empty())
+        return;
+      const size_t n = values.size();
+      auto begin = [&](int chunk) { return n * chunk / size_; };
+      auto wrap = [&](int chunk) { return ((chunk % size_) + size_) % size_; };
+      std::vector<T> incoming(n / size_ + 1);
+
+      for (int step = 0; step < size_ - 1; step++) {
+        const int send = wrap(rank_ - step), recv = wrap(rank_ - step - 1);
+        const size_t recvSize = begin(recv + 1) - begin(recv);
+        exchange(values.data() + begin(send), (begin(send + 1) - begin(send)) * sizeof(T),
+                 incoming.data(), recvSize * sizeof(T));
+        T* chunk = values.data() + begin(recv);
+        for (size_t i = 0; i < recvSize; i++)
+          chunk[i] = op == Op::Sum ? chunk[i] + incoming[i]
+                   : op == Op::Min ? std::min(chunk[i], incoming[i]) : std::max(chunk[i], incoming[i]);
+      }
+      // Rank r now holds the reduced chunk r + 1 and passes it on
+      for (int step = 0; step < size_ - 1; step++) {
+        const int send = wrap(rank_ - step + 1), recv = wrap(rank_ - step);
+        exchange(values.data() + begin(send), (begin(send + 1) - begin(send)) * sizeof(T),
+                 values.data() + begin(recv), (begin(recv + 1) - begin(recv)) * sizeof(T));
+      }
+    }
+
+  private:
+    // Sends to the next rank and receives from the previous one at once, so
+    // that no rank blocks on a full socket while its neighbour does the same
+    void exchange(const void* send, size_t sendBytes, void* recv, size_t recvBytes);
+    void disconnect();
+
+    int rank_;
+    int size_;
+    int next_;
+    int prev_;
+    std::string listenPath_;
+};
+
+#endif //DECISIONTREE_COMMUNICATOR_HPP
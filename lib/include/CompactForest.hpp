@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_COMPACTFOREST_HPP
+#define DECISIONTREE_COMPACTFOREST_HPP
+
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+#include "Predictor.hpp"
+#include "Tree.hpp"
+
+class DecisionTree;
+class Bagging;
+
+/**
+ * Quantised, cache-resident representation of a tree ensemble.
+ *
+ * Every node is an 8 byte record: a 16 bit column, a 16 bit split value and
+ * the index of its first child. Numeric thresholds are replaced by their rank
+ * among all thresholds the forest uses on that column, so a row is mapped to
+ * bin indices once and traversal compares 16 bit integers only. The nodes of
+ * each tree are stored breadth-first with siblings next to each other.
+ * Leaves refer to class distributions stored as 8 or 16 bit fixed point
+ * probabilities in a table shared by the whole forest, in which identical
+ * distributions with the same most likely class (e.g. all pure leaves of one
+ * class) are stored once.
+ */
+class CompactForest {
+  public:
+    CompactForest() = delete;
+    explicit CompactForest(const DecisionTree& tree, int probabilityBits = 16);
+    explicit CompactForest(const Bagging& bagging, Predictor::Voting voting = Predictor::Voting::Majority, int probabilityBits = 16);
+    CompactForest(const std::vector<const Tree*>& trees, int numClasses, Predictor::Voting voting, int probabilityBits);
+
+    int predict(const VecI& row) const;
+    void predictProba(const VecI& row, double* probabilities) const;
+    Predictions predict(const Data& rows) const;
+    Predictions predict(const Data& rows, ThreadPool& pool) const;
+
+    inline size_t numClasses() const { return numClasses_; }
+    inline size_t numTrees() const { return roots_.size(); }
+    inline size_t numNodes() const { return nodes_.size(); }
+
+    /**
+     * Memory used by the model tables.
+     */
+    size_t bytes() const;
+
+  private:
+    struct CompactNode {
+      uint16_t column; // tested column, kCategorical flags a categorical test, kLeaf a leaf
+      uint16_t split;  // numeric: bin a value must reach to go true; categorical: category set
+      uint32_t child;  // true child, the false child follows it; for a leaf: its distribution
+    };
+    static_assert(sizeof(CompactNode) == 8, "CompactNode should be 8 bytes");
+
+    static constexpr uint16_t kLeaf = 0xFFFF;
+    static constexpr uint16_t kCategorical = 0x8000;
+
+    void layout(const Tree& tree, std::map<std::vector<uint64_t>, uint16_t>& sets, std::map<std::pair<std::vector<uint16_t>, int>, uint32_t>& distributions);
+    void quantize(const VecI& row, uint16_t* bins) const;
+    inline uint32_t leafOf(uint32_t root, const uint16_t* bins) const;
+    inline void vote(uint32_t distribution, double* out) const;
+    void score(const Data& rows, size_t rowBegin, size_t rowEnd, double* out) const;
+
+    size_t numClasses_;
+    Predictor::Voting voting_;
+    int probabilityBits_;
+    std::vector<CompactNode> nodes_;
+    std::vector<uint32_t> roots_;
+    size_t numColumns_;
+    std::vector<uint8_t> categoricalColumns_;     // 1 if the column has categorical tests
+    std::vector<std::vector<int>> edges_;         // sorted thresholds per column
+    std::vector<uint32_t> categorySets_;          // offset, length pairs into categoryWords_
+    std::vector<uint64_t> categoryWords_;
+    std::vector<uint8_t> probabilities_;          // numClasses_ fixed point values per distribution
+    std::vector<uint16_t> labels_;                // most likely class per distribution
+};
+
+#endif //DECISIONTREE_COMPACTFOREST_HPP
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_CROSSVALIDATION_HPP
+#define DECISIONTREE_CROSSVALIDATION_HPP
+
+#include <ostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "ColumnStore.hpp"
+#include "ThreadPool.hpp"
+#include "TreeBuilder.hpp"
+
+/**
+ * One point of a hyperparameter grid.
+ */
+struct ModelConfig {
+  int ensembleSize = 1; // 1 learns a single tree on the training folds, more a bagged ensemble
+  TreeParams tree = {};
+
+  std::string toString() const;
+};
+
+/**
+ * Score and timings of one configuration on one fold.
+ */
+struct CrossValidationResult {
+  ModelConfig config = {};
+  int fold = 0;
+  double accuracy = 0;
+  double trainSeconds = 0;
+  double scoreSeconds = 0;
+};
+
+/**
+ * k-fold cross-validation and grid search driver.
+ *
+ * The data set is read once; folds are index lists into the shared column
+ * store, so its presorted indices serve every fold and configuration. All
+ * (fold, configuration) jobs are scheduled on one thread pool, and each job
+ * learns its trees on its own thread.
+ */
+class CrossValidation {
+  public:
+    CrossValidation() = delete;
+    CrossValidation(const ColumnStore& store, int folds, uint seed = 1234);
+
+    std::vector<CrossValidationResult> run(const std::vector<ModelConfig>& grid) const;
+    std::vector<CrossValidationResult> run(const std::vector<ModelConfig>& grid, ThreadPool& pool) const;
+
+    inline int folds() const { return folds_.size(); }
+    inline const VecIdx& fold(int k) const { return folds_[k]; }
+
+    /**
+     * Cartesian product of the given hyperparameter values.
+     */
+    static std::vector<ModelConfig> grid(const VecI& ensembleSizes, const VecI& maxDepths, const VecI& minSamplesSplits);
+
+    /**
+     * Prints every result followed by the mean per configuration.
+     */
+    static void print(const std::vector<CrossValidationResult>& results, std::ostream& out);
+
+  private:
+    CrossValidationResult evaluate(const ModelConfig& config, int k) const;
+
+    const ColumnStore& store_;
+    std::vector<VecIdx> folds_;
+    uint seed_;
+};
+
+#endif //DECISIONTREE_CROSSVALIDATION_HPP
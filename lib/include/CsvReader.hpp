@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_CSVREADER_HPP
+#define DECISIONTREE_CSVREADER_HPP
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include "ColumnStore.hpp"
+#include "Utils.hpp"
+
+/**
+ * Parser for delimited text files whose first line holds the column names.
+ *
+ * Without metadata to follow, the types are inferred: a column is numeric
+ * when all of its values parse as numbers and categorical otherwise, and the
+ * categories of every categorical column are numbered in order of first
+ * appearance. The class column, given by name or else the last one, is
+ * always categorical and is moved to the back. A file is read once unless a
+ * column turns out to be categorical after numeric values were stored for
+ * it, in which case it is read a second time with the final types.
+ *
+ * Given the metadata of another file, e.g. the training set, columns are
+ * matched on name and encoded with its types and codes; unseen categories
+ * are appended to the metadata.
+ *
+ * Numeric values are truncated to integers, as by DataReader. Fields may be
+ * quoted with double quotes.
+ */
+class CsvReader {
+  public:
+    explicit CsvReader(const std::string& classLabel = "", char delimiter = ',');
+
+    /**
+     * Reads filename into one column per attribute of meta, the class last.
+     * An empty meta is filled in from the file.
+     */
+    void read(const std::string& filename, MetaData& meta, std::vector<VecI>& columns) const;
+
+    ColumnStore read(const std::string& filename) const;
+    ColumnStore read(const std::string& filename, const MetaData& reference) const;
+
+  private:
+    bool readPass(const std::string& filename, MetaData& meta, std::vector<VecI>& columns, bool infer) const;
+    void split(const std::string& line, VecS& fields) const;
+
+    const std::string classLabel_;
+    const char delimiter_;
+};
+
+#endif //DECISIONTREE_CSVREADER_HPP
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_DATAPARALLELBUILDER_HPP
+#define DECISIONTREE_DATAPARALLELBUILDER_HPP
+
+#include "ColumnStore.hpp"
+#include "Communicator.hpp"
+#include "Tree.hpp"
+#include "TreeBuilder.hpp"
+#include "TreeStats.hpp"
+
+/**
+ * CART learner over worker processes that each own a shard of the rows.
+ *
+ * Numeric features are binned on cut points that all workers agree on: one
+ * bin per value when the global range of the feature holds at most maxBins
+ * values, else maxBins bins of equal width. The range comes from a min and a
+ * max all-reduce, so it does not depend on how the rows are sharded.
+ * Categories are bins of their own.
+ *
+ * For every node, the workers first all-reduce the class counts of their
+ * own rows. Only when the node can split do they count the classes per bin
+ * of every feature; one all-reduce of these histograms gives every worker
+ * the counts of the whole node, from which they all derive the same Question
+ * and partition their own rows. All workers visit the nodes in the same
+ * order, so they end with the same tree, which is also the tree that a single
+ * process builds on all rows with the same binning.
+ *
+ * The construction and build() are collective: every worker of the
+ * communicator calls them, with shards that share the metadata of the data
+ * set (e.g. read from files with the same header). Only maxDepth,
+ * minSamplesSplit and smoothing of the parameters are used.
+ */
+class DataParallelBuilder {
+  public:
+    DataParallelBuilder() = delete;
+    DataParallelBuilder(const ColumnStore& shard, Communicator& comm, const TreeParams& params = TreeParams(), int maxBins = 256);
+
+    Tree build();
+
+    // Cut points of numeric feature f: bin b holds the values in
+    // [cuts[b-1], cuts[b]). Empty for categorical features.
+    inline const VecI& cuts(int f) const { return cuts_[f]; }
+
+  private:
+    NodeId buildTree(Tree& tree, TreeStats& stats, RowView rows, int depth);
+    void histogram(RowView rows, VecI& counts) const;
+
+    const ColumnStore& store_;
+    Communicator& comm_;
+    TreeParams params_;
+    int numClasses_;
+    std::vector<VecI> cuts_;
+    // Offset of each feature in a histogram, numClasses_ counts per bin
+    std::vector<size_t> offset_;
+    // Bin of every feature for every row of the shard
+    std::vector<std::vector<uint16_t>> bins_;
+};
+
+#endif //DECISIONTREE_DATAPARALLELBUILDER_HPP
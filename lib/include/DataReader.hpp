@@ -9,8 +9,11 @@
 
 #include <iostream>
 #include <fstream>
+#include <memory>
 #include <vector>
 #include <boost/algorithm/string.hpp>
+#include "ArffPipeline.hpp"
+#include "ColumnStore.hpp"
 #include "Dataset.hpp"
 #include "Utils.hpp"
 
@@ -18,7 +21,13 @@
  * Implementation of a parser for data sets in the ARFF format.
  *
  * The specification of the Attribute-Relation File Format (ARFF) can be found
- * at <https://www.cs.waikato.ac.nz/ml/weka/arff.html>.
+ * at <https://www.cs.waikato.ac.nz/ml/weka/arff.html>. Files ending in .csv
+ * are read by CsvReader instead, with the types and categories inferred
+ * from the training file.
+ *
+ * The headers are parsed here; the data sections of the training and test
+ * file are read together by an ArffPipeline. The class attribute is moved
+ * to the back of each file's attributes, with the file's own field order.
  *
  * TODO: A working implementation is provided, although you might want to make
  * some changes to enable faster decision tree learning. The definition of the
@@ -34,26 +43,34 @@ class DataReader
     inline const Data& trainData() const { return trainData_; }
     inline const Data& testData() const { return testData_; }
     inline const MetaData& metaData() const { return trainMetaData_; }
+    inline const ColumnStore& columns() const { return *columns_; }
 
-    inline const void setBaggingData(Data &data){  backupTrainData_=trainData_; trainData_=data;}
-    inline const void resetBaggingData(){ trainData_=backupTrainData_; backupTrainData_={};}
+    inline const void setBaggingData(Data &data){  backupTrainData_=trainData_; trainData_=data; buildColumns();}
+    inline const void resetBaggingData(){ trainData_=backupTrainData_; backupTrainData_={}; buildColumns();}
 
   private:
-    void processFile(const std::string& strings, Data& data, MetaData &meta);
-    void moveClassDataToBack(VecS &line, const VecS &labels) const;
-    void moveClassLabelToBack();
-    void trimWhiteSpaces(VecS &line);
+    void readHeader(const std::string& filename, MetaData& meta, Data& data,
+        std::vector<ArffPipeline::Input>& inputs) const;
+    void readCsv(const Dataset& dataset);
+    void alignTestCodes();
+    static void toRows(const std::vector<VecI>& columns, Data& data);
+    VecI moveClassLabelToBack(MetaData& meta) const;
+    static void trimWhiteSpaces(VecS &line);
+    void buildColumns();
 
-    bool parseHeaderLine(const std::string& line, MetaData &meta, bool &header_loaded);
-    bool parseDataLine(const std::string& line, Data &data, MetaData &meta);
+    bool parseHeaderLine(const std::string& line, MetaData &meta, bool &header_loaded) const;
 
     const std::string classLabel_;
+    const double sketchEpsilon_;
+    const bool reduceFeatures_;
     Data trainData_;
     Data backupTrainData_;
     Data testData_;
     MetaData trainMetaData_;
     MetaData testMetaData_;
     DMapIS dMapIS_;
+    // Column-major copy of the training data, shared by copies of the reader
+    std::shared_ptr<const ColumnStore> columns_;
 
 };
 
@@ -18,6 +18,7 @@ struct Train {
 
 /**
  * Holds the path of file containing data that is used during the test phase.
+ * May be left empty when the test data is streamed instead.
  */
 struct Test {
   std::string filename;
@@ -26,12 +27,17 @@ struct Test {
 /**
  * A data set consists out of two data files: one used to train a classifier,
  * the other used to validate the learned model. Additionaly, this struct
- * stores the label of the target column.
+ * stores the label of the target column, the error of the quantile
+ * sketches built for the training columns, if any, and whether constant,
+ * duplicate and mutually exclusive training columns are reduced (see
+ * ColumnStore::reduceFeatures).
  */
 struct Dataset {
   Train train;
   Test test;
   std::string classLabel;
+  double sketchEpsilon = 0; // 0 builds no sketches
+  bool reduceFeatures = false;
 };
 
 #endif //DECISIONTREE_DATASET_HPP
@@ -9,7 +9,8 @@
 
 #include "Calculations.hpp"
 #include "DataReader.hpp"
-#include "Node.hpp"
+#include "Tree.hpp"
+#include "TreeBuilder.hpp"
 #include "TreeTest.hpp"
 #include "Utils.hpp"
 
@@ -18,19 +19,38 @@ class DecisionTree {
     DecisionTree() = delete;
     explicit DecisionTree(const DataReader& dr);
     explicit DecisionTree(const DataReader& dr, const std::vector<size_t>& samples);
+    DecisionTree(const DataReader& dr, const std::vector<size_t>& samples, const TreeParams& params);
 
     void print() const;
     void test() const;
 
+    /**
+     * Prints the subtree of tree rooted at node, e.g. of a tree learned by
+     * another learner.
+     */
+    static void print(const Tree& tree, const MetaData& meta, NodeId node, std::string spacing="");
+
     inline Data testData() { return dr_.testData(); }
-    inline std::shared_ptr<Node> root() { return std::make_shared<Node>(root_); }
+    inline const Tree& tree() const { return tree_; }
+    inline const MetaData& metaData() const { return dr_.metaData(); }
+    inline int numClasses() const { return dr_.columns().numClasses(); }
+    inline const TreeStats& stats() const { return tree_.stats(); }
+
+    /**
+     * Impurity decrease per feature, normalised to sum to one.
+     */
+    std::vector<double> featureImportance() const;
+
+    /**
+     * Decrease in accuracy on data when a feature is shuffled.
+     */
+    std::vector<double> permutationImportance(const Data& data, int repeats = 5, uint seed = 1234) const;
 
-    Node root_;
   private:
     DataReader dr_;
+    Tree tree_;
 
-    const Node buildTree(const Data& rows, const MetaData &meta);
-    void print(const std::shared_ptr<Node> root, std::string spacing="") const;
+    static Tree build(const DataReader& dr, VecIdx rows, const TreeParams& params);
 
 };
 
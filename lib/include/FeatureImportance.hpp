@@ -0,0 +1,32 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_FEATUREIMPORTANCE_HPP
+#define DECISIONTREE_FEATUREIMPORTANCE_HPP
+
+#include <iostream>
+#include <vector>
+#include "Predictor.hpp"
+#include "Tree.hpp"
+#include "Utils.hpp"
+
+namespace FeatureImportance {
+
+// Impurity decrease per feature, normalised within every tree and averaged
+// over the trees.
+std::vector<double> impurity(const std::vector<const Tree*>& trees, int numFeatures);
+
+// Decrease in accuracy on data when the values of one feature are shuffled
+// over the rows, averaged over repeats. Every shuffled copy is scored as one
+// batch by the predictor.
+std::vector<double> permutation(const Predictor& predictor, const Data& data, int repeats = 5, uint seed = 1234);
+
+// Features from most to least important.
+void print(const std::vector<double>& importance, const MetaData& meta, std::ostream& out);
+
+} // namespace FeatureImportance
+
+#endif //DECISIONTREE_FEATUREIMPORTANCE_HPP
@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_HOEFFDINGTREE_HPP
+#define DECISIONTREE_HOEFFDINGTREE_HPP
+
+#include <limits>
+#include <vector>
+#include "Question.hpp"
+#include "Tree.hpp"
+#include "Utils.hpp"
+
+/**
+ * Hyperparameters of online tree learning.
+ */
+struct HoeffdingParams {
+  // Probability that a split differs from the one on infinite data
+  double delta = 1e-7;
+  // Splits on near-ties are taken once the bound drops below this value
+  double tieThreshold = 0.05;
+  // Rows a leaf receives between two split attempts
+  int gracePeriod = 200;
+  // Candidate thresholds kept per numeric attribute and leaf
+  int maxBins = 64;
+  int maxDepth = std::numeric_limits<int>::max();
+};
+
+/**
+ * Online decision tree learner (Hoeffding tree, [DH00]).
+ *
+ * Rows are routed to a leaf, one at a time or in mini-batches, and only
+ * update the sufficient statistics of that leaf: its class counts, class
+ * counts per category of every categorical attribute, and class counts per
+ * candidate threshold of every numeric attribute. Every gracePeriod rows a
+ * leaf compares the gini gain of the best split of every attribute; it
+ * splits once the best attribute beats the runner-up by more than the
+ * Hoeffding bound sqrt(ln(1/delta) / 2n). An update thus costs one walk
+ * down the tree and a constant amount of work per attribute.
+ *
+ * Numeric candidate thresholds are kept in a bounded histogram: when a leaf
+ * sees more distinct values than maxBins, the two neighbouring bins with
+ * the fewest rows are merged into one bin covering both ranges. Later values
+ * inside a merged range are counted in that bin rather than opening a new
+ * one. This only removes candidate thresholds; the counts on either side of
+ * the remaining ones stay exact. Categorical
+ * splits are found by ordering the categories on class proportion, as in
+ * Calculations::determine_best_subset_cat.
+ *
+ * tree() returns a snapshot with the usual Question and Leaf nodes, which
+ * DecisionTree::print, TreeTest and Predictor accept.
+ *
+ * [DH00] Domingos, P. and Hulten, G. (2000). Mining high-speed data streams.
+ */
+class HoeffdingTree {
+  public:
+    HoeffdingTree() = delete;
+    explicit HoeffdingTree(const MetaData& meta, const HoeffdingParams& params = HoeffdingParams());
+
+    void update(const VecI& row);
+    void update(const Data& rows);
+
+    int predict(const VecI& row) const;
+
+    /**
+     * Snapshot of the current tree; at least one row must have been seen.
+     */
+    Tree tree() const;
+
+    void print() const;
+    void test(const Data& testData) const;
+
+    inline size_t rowsSeen() const { return rowsSeen_; }
+    inline size_t numLeaves() const { return leaves_.size(); }
+    inline const MetaData& metaData() const { return meta_; }
+
+  private:
+    struct OnlineNode {
+      Question question;
+      int trueBranch;
+      int falseBranch;
+      int leaf;  // index of the statistics, -1 for a split node
+      int depth;
+    };
+
+    // Class counts per candidate threshold, sorted on value
+    // Bin i holds the rows with a value in [values[i], uppers[i]]
+    struct Histogram {
+      VecI values = {};
+      VecI uppers = {};
+      VecI counts = {}; // numClasses per bin
+      VecI totals = {};
+    };
+
+    struct LeafStats {
+      VecI classCounts = {}; // for prediction, including those inherited at the split
+      VecI seenCounts = {};  // of the rows seen by the leaf itself
+      int seen = 0;
+      int lastCheck = 0;  // seen at the last split attempt
+      std::vector<Histogram> numeric = {};
+      std::vector<VecI> categorical = {}; // numClasses per category
+    };
+
+    // Best split on one attribute, with the class counts of its true branch
+    struct Candidate {
+      double gain = -std::numeric_limits<double>::infinity();
+      Question question = Question();
+      VecI trueCounts = {};
+    };
+
+    int leafOf(const VecI& row) const;
+    void add(LeafStats& stats, const VecI& row) const;
+    void addNumeric(Histogram& histogram, int value, int label) const;
+    Candidate bestNumeric(const LeafStats& stats, int f) const;
+    Candidate bestCategorical(const LeafStats& stats, int f) const;
+    void attemptSplit(int node);
+    int newLeaf(const VecI& classCounts, int depth, int slot = -1);
+    NodeId exportNode(Tree& tree, int node) const;
+
+    MetaData meta_;
+    HoeffdingParams params_;
+    int numFeatures_;
+    int numClasses_;
+    std::vector<bool> numeric_;
+    std::vector<OnlineNode> nodes_;
+    std::vector<LeafStats> leaves_;
+    size_t rowsSeen_;
+};
+
+#endif //DECISIONTREE_HOEFFDINGTREE_HPP
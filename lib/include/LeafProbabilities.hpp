@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_LEAFPROBABILITIES_HPP
+#define DECISIONTREE_LEAFPROBABILITIES_HPP
+
+#include <vector>
+#include "Leaf.hpp"
+#include "Utils.hpp"
+
+/**
+ * Targets predicted by a tree: the number of classes of every output and,
+ * with several outputs, the class of each output for every joint class the
+ * tree is learned on.
+ */
+struct OutputLayout {
+  VecI numClasses = {}; // per output
+  VecI outputClass = {}; // numOutputs() per joint class, empty for one output
+
+  inline size_t numOutputs() const { return numClasses.size(); }
+  inline int classOf(int joint, size_t output) const {
+    return outputClass.empty() ? joint : outputClass[joint * numOutputs() + output];
+  }
+
+  static OutputLayout single(int numClasses);
+};
+
+/**
+ * Normalised class probabilities of the leaves of a tree, in one contiguous
+ * pool indexed by leaf id.
+ *
+ * Each leaf holds the probabilities of its first output, followed by those of
+ * the next. They are computed once from the class counts of the leaf,
+ * optionally with Laplace smoothing: (count + alpha) / (total + alpha * K)
+ * for an output of K classes. Lookups return views into the pool.
+ */
+class LeafProbabilities {
+  public:
+    LeafProbabilities() = default;
+    LeafProbabilities(const OutputLayout& layout, double smoothing);
+
+    /**
+     * Appends the probabilities of the next leaf, from its joint class counts.
+     */
+    void add(const ClassCounter& counts);
+
+    inline ProbabilityView of(Idx leaf, size_t output = 0) const {
+      const double* first = pool_.data() + leaf * stride_ + offset_[output];
+      return ProbabilityView{first, first + (offset_[output + 1] - offset_[output])};
+    }
+
+    inline bool empty() const { return pool_.empty(); }
+    inline size_t numOutputs() const { return layout_.numOutputs(); }
+    inline const OutputLayout& layout() const { return layout_; }
+
+  private:
+    OutputLayout layout_ = {};
+    double smoothing_ = 0;
+    VecIdx offset_ = {0}; // of every output within a leaf, and the stride last
+    size_t stride_ = 0;
+    std::vector<double> pool_ = {};
+};
+
+#endif //DECISIONTREE_LEAFPROBABILITIES_HPP
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_LIBSVMREADER_HPP
+#define DECISIONTREE_LIBSVMREADER_HPP
+
+#include <string>
+#include "ColumnStore.hpp"
+#include "Utils.hpp"
+
+/**
+ * Parser for sparse data in the LIBSVM text format, one row per line:
+ *
+ *     <label> <index>:<value> <index>:<value> ... [# comment]
+ *
+ * with 1-based, increasing feature indices. The rows go straight into the
+ * sparse layout of a ColumnStore; absent features are zero and are never
+ * materialised.
+ *
+ * Every feature becomes a numeric attribute named after its index ("f1",
+ * "f2", ...), and the class labels are numbered in order of first appearance.
+ * Values are multiplied by scale and truncated to integers, like all numeric
+ * values of the learner; a scale of 1000 keeps three decimals of features
+ * normalised to [0, 1]. Values that become zero are dropped.
+ */
+class LibsvmReader {
+  public:
+    explicit LibsvmReader(double scale = 1.0);
+
+    /**
+     * Reads filename into matrix and labels. An empty meta is filled in with
+     * as many features as the largest index in the file; otherwise features
+     * beyond those of meta are ignored and unseen labels are appended.
+     */
+    void read(const std::string& filename, MetaData& meta, SparseMatrix& matrix, VecI& labels) const;
+
+    ColumnStore read(const std::string& filename) const;
+    ColumnStore read(const std::string& filename, const MetaData& reference) const;
+
+  private:
+    const double scale_;
+};
+
+#endif //DECISIONTREE_LIBSVMREADER_HPP
@@ -7,10 +7,13 @@
 #ifndef DECISIONTREE_NODE_HPP
 #define DECISIONTREE_NODE_HPP
 
-#include <memory>
+#include <limits>
 #include "Leaf.hpp"
 #include "Question.hpp"
 
+using NodeId = Idx;
+constexpr NodeId kNoNode = std::numeric_limits<NodeId>::max();
+
 /**
  * Representation of a decision tree node.
  *
@@ -19,25 +22,27 @@
  * question decides whether a specific example if forwarded to the true or
  * false branch of the node.
  *
- * NOTE: This class should not be altered!
+ * Children and leaves are referred to by their index in the arenas of the
+ * owning Tree.
  */
 class Node {
   public:
     Node();
-    explicit Node(Leaf l);
-    Node(const Node& trueBranch, const Node& falseBranch, const Question &question);
+    explicit Node(Idx leaf);
+    Node(NodeId trueBranch, NodeId falseBranch, const Question &question);
     virtual ~Node() = default;
 
-    const std::shared_ptr<Node> trueBranch() const { return trueBranch_; }
-    const std::shared_ptr<Node> falseBranch() const { return falseBranch_; }
-    const Question& question() const { return question_; }
-    const std::shared_ptr<Leaf> leaf() const { return leaf_; }
+    inline NodeId trueBranch() const { return trueBranch_; }
+    inline NodeId falseBranch() const { return falseBranch_; }
+    inline const Question& question() const { return question_; }
+    inline Idx leaf() const { return leaf_; }
+    inline bool isLeaf() const { return leaf_ != kNoNode; }
 
   private:
-    std::shared_ptr<Node> trueBranch_;
-    std::shared_ptr<Node> falseBranch_;
+    NodeId trueBranch_;
+    NodeId falseBranch_;
     Question question_;
-    std::shared_ptr<Leaf> leaf_;
+    Idx leaf_;
 };
 
 #endif //DECISIONTREE_NODE_HPP
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_NUMA_HPP
+#define DECISIONTREE_NUMA_HPP
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "ThreadPool.hpp"
+
+/**
+ * NUMA topology, read through libnuma when the library is built with
+ * DECISIONTREE_NUMA. Without it, or when libnuma reports no NUMA support,
+ * the machine is a single node.
+ *
+ * The environment variable DECISIONTREE_NUMA_NODES overrides the number of
+ * nodes, which allows exercising the multi-node code paths on a single
+ * node; simulated nodes are mapped onto the real ones round-robin.
+ */
+namespace Numa {
+
+bool available();
+
+int numNodes();
+
+// Number of CPUs of node, at least 1
+size_t numCpus(int node);
+
+// Restricts the calling thread to the CPUs of node and makes its
+// allocations local to it
+void bindThread(int node);
+
+// Node holding the page of address, -1 when unknown
+int nodeOfAddress(const void* address);
+
+} // namespace Numa
+
+/**
+ * One thread pool per NUMA node, its workers bound to the node.
+ *
+ * Memory is placed on the node of the thread that first writes it, so data
+ * that is built by the workers of a node and later scanned by them stays
+ * local. With a single node the shared pool is used.
+ */
+class NumaPools {
+  public:
+    NumaPools();
+    NumaPools(const NumaPools&) = delete;
+    NumaPools& operator=(const NumaPools&) = delete;
+
+    inline int numNodes() const { return numNodes_; }
+    ThreadPool& pool(int node);
+
+    /**
+     * Calls body(i) for every i in [0, n) on a worker of node nodeOf(i), and
+     * returns once all calls are done.
+     */
+    template<typename N, typename F>
+      void parallelFor(size_t n, N&& nodeOf, F&& body) {
+        if (numNodes_ == 1) {
+          pool(0).parallelFor(n, body);
+          return;
+        }
+        std::vector<std::vector<size_t>> items(numNodes_);
+        for (size_t i = 0; i < n; i++)
+          items[nodeOf(i)].push_back(i);
+        std::mutex mutex;
+        std::condition_variable finished;
+        size_t pending = 0;
+        for (int node = 0; node < numNodes_; node++) {
+          if (items[node].empty())
+            continue;
+          pending++;
+          ThreadPool* nodePool = &pool(node);
+          const std::vector<size_t>* ofNode = &items[node];
+          nodePool->submit([&mutex, &finished, &pending, &body, nodePool, ofNode]() {
+            nodePool->parallelFor(ofNode->size(), [&](size_t k) { body((*ofNode)[k]); });
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--pending == 0)
+              finished.notify_all();
+          });
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&pending]() { return pending == 0; });
+      }
+
+    /**
+     * Process-wide pools, one per node.
+     */
+    static NumaPools& shared();
+
+  private:
+    const int numNodes_;
+    std::vector<std::unique_ptr<ThreadPool>> pools_;
+};
+
+#endif //DECISIONTREE_NUMA_HPP
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_PREDICTOR_HPP
+#define DECISIONTREE_PREDICTOR_HPP
+
+#include <cstdint>
+#include <vector>
+#include "ColumnStore.hpp"
+#include "Tree.hpp"
+#include "ThreadPool.hpp"
+#include "Utils.hpp"
+
+class DecisionTree;
+class Bagging;
+
+/**
+ * Class probabilities and most likely class of a batch of rows.
+ *
+ * Probabilities are stored row-major, numClasses values per row.
+ */
+struct Predictions {
+  size_t numClasses = 0;
+  std::vector<double> probabilities = {};
+  VecI labels = {};
+
+  inline const double* probabilitiesOf(size_t row) const { return probabilities.data() + row * numClasses; }
+  inline size_t size() const { return labels.size(); }
+
+  /**
+   * Fraction of rows whose prediction equals the class in the last column.
+   */
+  double accuracy(const Data& data) const;
+};
+
+/**
+ * Immutable, thread-safe scoring engine for a single tree or an ensemble.
+ *
+ * The trees are flattened into contiguous node and leaf tables when the
+ * predictor is built, after which all methods are const and free of shared
+ * mutable state: any number of threads can score concurrently without
+ * locking. Large batches are split over rows and trees and scored on the
+ * shared thread pool; small batches are scored on the calling thread.
+ *
+ * Leaf probabilities are copied from the probability pools of the trees,
+ * smoothing included. Trees with several outputs keep all of them in the
+ * leaf table; voting and the class predictions are on the first output.
+ */
+class Predictor {
+  public:
+    enum class Voting {
+      Majority, // every tree votes for its most likely class
+      Average   // class probabilities of the trees are averaged
+    };
+
+    /**
+     * Rule for stopping the evaluation of an ensemble on a single row before
+     * all trees have voted. With a confidence of 1 the prediction is stopped
+     * only when the remaining trees can no longer change it, so the result is
+     * exact. Below 1 it also stops once the lead of the winning class over
+     * the runner-up exceeds a Hoeffding bound, at which the chance that the
+     * full ensemble disagrees is at most 1 - confidence.
+     */
+    struct EarlyExit {
+      double confidence = 1.0;
+      size_t minTrees = 1;
+    };
+
+    // Rows handed to one task when a batch is split up
+    static constexpr size_t kRowBlock = 256;
+    // Below this many row-tree evaluations a batch is scored on the calling thread
+    static constexpr size_t kParallelWork = size_t(1) << 15;
+
+    Predictor() = delete;
+    explicit Predictor(const DecisionTree& tree);
+    explicit Predictor(const Bagging& bagging, Voting voting = Voting::Majority);
+    Predictor(const std::vector<const Tree*>& trees, int numClasses, Voting voting = Voting::Majority);
+
+    int predict(const VecI& row) const;
+    void predictProba(const VecI& row, double* probabilities) const;
+
+    /**
+     * Evaluates the trees in order until the rule allows to stop. The number
+     * of trees evaluated is stored in treesUsed when given.
+     */
+    int predict(const VecI& row, const EarlyExit& rule, size_t* treesUsed = nullptr) const;
+
+    /**
+     * Copy of the predictor evaluating its trees in the given order, e.g.
+     * the one of rankTrees().
+     */
+    Predictor reordered(const VecIdx& order) const;
+
+    /**
+     * Trees from most to least accurate on data, a good order for early
+     * exit: easy rows are settled by the first few trees. The data should
+     * be held out from training (e.g. a validation set): on the rows a tree
+     * was grown on, every tree looks about equally accurate.
+     */
+    VecIdx rankTrees(const Data& data) const;
+    Predictions predict(const Data& rows) const;
+    Predictions predict(const Data& rows, ThreadPool& pool) const;
+
+    /**
+     * Scores row r of a column store, reading the attributes in place, so
+     * that sparse data is never expanded.
+     */
+    int predict(const ColumnStore& store, Idx r) const;
+    void predictProba(const ColumnStore& store, Idx r, double* probabilities) const;
+
+    /**
+     * Class probabilities of output in the leaf of tree t that row ends up
+     * in, as a view into the leaf table of the predictor.
+     */
+    ProbabilityView leafProbabilities(const VecI& row, size_t t = 0, size_t output = 0) const;
+
+    inline size_t numClasses() const { return numClasses_; }
+    inline size_t numOutputs() const { return outputOffset_.size() - 1; }
+    inline size_t numTrees() const { return roots_.size(); }
+
+    /**
+     * Memory used by the flattened node and leaf tables.
+     */
+    size_t bytes() const;
+
+  private:
+    struct FlatNode {
+      int32_t column;      // tested column, or -1 for a leaf
+      int32_t threshold;   // numeric threshold
+      uint32_t categories; // offset of the category bitset in categoryWords_
+      uint32_t numWords;   // length of the bitset, 0 for numeric tests
+      uint32_t trueBranch; // for a leaf: index of the leaf
+      uint32_t falseBranch;
+    };
+
+    uint32_t flatten(const Tree& tree, NodeId id);
+    template <typename Row>
+    inline uint32_t leafOf(uint32_t node, const Row& row) const;
+    inline void vote(uint32_t leaf, double* out) const;
+    void score(const Data& rows, size_t rowBegin, size_t rowEnd, size_t treeBegin, size_t treeEnd, double* out) const;
+
+    size_t numClasses_;
+    Voting voting_;
+    std::vector<FlatNode> nodes_;
+    std::vector<uint32_t> roots_;
+    std::vector<uint64_t> categoryWords_;
+    VecIdx outputOffset_;                   // of every output within a leaf
+    std::vector<double> leafProbabilities_; // outputOffset_.back() per leaf
+    VecI leafLabels_;                       // most likely class per leaf
+};
+
+#endif //DECISIONTREE_PREDICTOR_HPP
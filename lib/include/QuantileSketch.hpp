@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_QUANTILESKETCH_HPP
+#define DECISIONTREE_QUANTILESKETCH_HPP
+
+#include <cstdint>
+#include <vector>
+#include "Utils.hpp"
+
+/**
+ * Mergeable summary of the distribution of an integer attribute, in the
+ * style of the weighted quantile summaries of Greenwald-Khanna [GK01] and
+ * XGBoost [CG16].
+ *
+ * The summary keeps a bounded number of values, each with a lower and upper
+ * bound on the number of values below it. A sketch of one batch is exact
+ * until it is pruned to its budget of ceil(6 / epsilon) entries; merging two
+ * sketches adds their bounds. Sketches of the parts of a column merged in a
+ * balanced tree keep at most epsilon * count() values between two adjacent
+ * entries, which gap() reports.
+ *
+ * [GK01] Greenwald, M., and Khanna, S. Space-efficient online computation of
+ *        quantile summaries. SIGMOD 2001.
+ * [CG16] Chen, T., and Guestrin, C. XGBoost: A scalable tree boosting system.
+ *        KDD 2016.
+ */
+class QuantileSketch {
+  public:
+    explicit QuantileSketch(double epsilon = 0.01);
+    // Sketch of the values in [first, last)
+    QuantileSketch(const int* first, const int* last, double epsilon);
+
+    void merge(const QuantileSketch& other);
+
+    inline uint64_t count() const { return entries_.empty() ? 0 : entries_.back().rmax; }
+    inline size_t size() const { return entries_.size(); }
+    inline double epsilon() const { return epsilon_; }
+
+    /**
+     * Largest fraction of the values that may lie strictly between two
+     * adjacent entries.
+     */
+    double gap() const;
+
+    /**
+     * Value whose rank is closest to q * count(), for q in [0, 1].
+     */
+    int quantile(double q) const;
+
+    /**
+     * Kept values in ascending order; the smallest and largest value seen are
+     * always among them. These are the candidate split thresholds.
+     */
+    VecI values() const;
+
+  private:
+    struct Entry {
+      int value;
+      uint64_t rmin;   // values certainly below value
+      uint64_t rmax;   // values possibly at or below value
+      uint64_t weight; // occurrences of value itself
+      inline uint64_t rminNext() const { return rmin + weight; }
+      inline uint64_t rmaxPrev() const { return rmax - weight; }
+    };
+
+    void prune();
+
+    double epsilon_;
+    size_t budget_;
+    std::vector<Entry> entries_;
+};
+
+#endif //DECISIONTREE_QUANTILESKETCH_HPP
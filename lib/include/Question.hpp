@@ -7,6 +7,7 @@
 #ifndef DECISIONTREE_QUESTION_HPP
 #define DECISIONTREE_QUESTION_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -15,22 +16,37 @@
 /**
  * Representation of a "test" on an attritbute.
  *
+ * A numeric test checks `value >= value_`. A categorical test checks whether
+ * the category code is a member of a set, stored as a bitset over the dense
+ * category codes so that membership is a single word lookup.
+ *
  * NOTE: This class can be modified.
  */
 class Question {
   public:
     Question();
     Question(const int column, const int value, const MetaData& meta);
+    Question(const int column, const VecI& categories, const MetaData& meta);
 
     inline const bool isNumeric() const {return isNumeric_;};
-    const bool solve(VecI example) const;
+    const bool solve(const VecI& example) const;
     const std::string toString(const MetaData& meta) const;
 
+    inline bool matches(int value) const {
+      return isNumeric_ ? value >= value_ : contains(value);
+    }
+    inline bool contains(int category) const {
+      const size_t word = static_cast<size_t>(category) >> 6;
+      return word < categories_.size() && (categories_[word] >> (category & 63)) & 1;
+    }
+    inline const std::vector<uint64_t>& categories() const { return categories_; }
+
     int column_;
     int value_;
     
   private:
     bool isNumeric_;
+    std::vector<uint64_t> categories_;
 
 };
 
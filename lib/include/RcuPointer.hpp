@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_RCUPOINTER_HPP
+#define DECISIONTREE_RCUPOINTER_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+/**
+ * Pointer to an immutable object that a fixed set of readers use while a
+ * writer replaces it, read-copy-update style with epochs [Fra04].
+ *
+ * A reader announces the current epoch in its own slot before it loads the
+ * pointer, and clears the slot when done. publish() swaps the pointer in,
+ * starts a new epoch and waits until no reader is left in an older epoch
+ * before it frees the previous object. Readers never wait and never touch a
+ * shared counter; only the writer waits, for the readers that were already
+ * using the old object to finish.
+ *
+ * Every reader has an index below the number of readers given at
+ * construction, and holds at most one guard at a time.
+ *
+ * [Fra04] Fraser, K. Practical lock-freedom. PhD thesis, University of
+ *         Cambridge, 2004.
+ */
+template<typename T>
+class RcuPointer {
+  public:
+    class Guard {
+      public:
+        Guard(const Guard&) = delete;
+        Guard& operator=(const Guard&) = delete;
+        ~Guard() { slot_.store(kIdle, std::memory_order_release); }
+
+        inline const T& operator*() const { return *value_; }
+        inline const T* operator->() const { return value_; }
+
+      private:
+        friend class RcuPointer;
+        Guard(std::atomic<uint64_t>& slot, const T* value) : slot_(slot), value_(value) {}
+
+        std::atomic<uint64_t>& slot_;
+        const T* value_;
+    };
+
+    RcuPointer(size_t readers, std::unique_ptr<const T> value) :
+        current_(value.release()), epoch_(1), readers_(readers), slots_(new Slot[readers]), writer_() {
+    }
+    RcuPointer(const RcuPointer&) = delete;
+    RcuPointer& operator=(const RcuPointer&) = delete;
+    ~RcuPointer() { delete current_.load(); }
+
+    Guard read(size_t reader) const {
+      std::atomic<uint64_t>& slot = slots_[reader].epoch;
+      slot.store(epoch_.load());
+      return Guard(slot, current_.load());
+    }
+
+    /**
+     * Replaces the object; returns once the previous one is freed.
+     */
+    void publish(std::unique_ptr<const T> value) {
+      std::lock_guard<std::mutex> lock(writer_);
+      const T* previous = current_.exchange(value.release());
+      const uint64_t epoch = epoch_.fetch_add(1) + 1;
+      for (size_t r = 0; r < readers_; r++) {
+        // A reader of an older epoch may still hold previous
+        while (true) {
+          const uint64_t seen = slots_[r].epoch.load();
+          if (seen == kIdle || seen >= epoch)
+            break;
+          std::this_thread::yield();
+        }
+      }
+      delete previous;
+    }
+
+    // Number of objects published so far, the first included
+    inline uint64_t version() const { return epoch_.load(); }
+
+  private:
+    static constexpr uint64_t kIdle = 0;
+
+    struct Slot {
+      alignas(64) std::atomic<uint64_t> epoch{kIdle};
+    };
+
+    std::atomic<const T*> current_;
+    std::atomic<uint64_t> epoch_;
+    const size_t readers_;
+    std::unique_ptr<Slot[]> slots_;
+    std::mutex writer_;
+};
+
+#endif //DECISIONTREE_RCUPOINTER_HPP
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_ROWSTREAM_HPP
+#define DECISIONTREE_ROWSTREAM_HPP
+
+#include <fstream>
+#include <string>
+#include "Utils.hpp"
+
+/**
+ * Chunked reader of rows from an ARFF or CSV file.
+ *
+ * Values are encoded with the metadata of the training set: categorical
+ * values get the codes used during training (-1 when unseen), and columns are
+ * matched on their name, so the file may order them differently. The class
+ * column is optional; when missing it is set to -1. A CSV file must start
+ * with a line of column names.
+ *
+ * Only one chunk is held in memory at a time, and the rows of the chunk are
+ * reused by the next call.
+ */
+class RowStream {
+  public:
+    RowStream() = delete;
+    RowStream(const std::string& filename, const MetaData& meta);
+
+    /**
+     * Reads up to maxRows rows into chunk and returns the number read; 0 at
+     * the end of the file.
+     */
+    size_t next(Data& chunk, size_t maxRows);
+
+  private:
+    void readHeader();
+    void parseLine(const std::string& line, VecI& row) const;
+
+    std::ifstream file_;
+    const MetaData& meta_;
+    VecI target_; // column of the row each field is stored in, -1 to skip
+    std::string line_;
+    size_t lineNumber_;
+};
+
+#endif //DECISIONTREE_ROWSTREAM_HPP
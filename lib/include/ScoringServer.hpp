@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_SCORINGSERVER_HPP
+#define DECISIONTREE_SCORINGSERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.hpp"
+#include "Predictor.hpp"
+#include "RcuPointer.hpp"
+
+/**
+ * Batching and threading of a ScoringServer.
+ */
+struct ScoringOptions {
+  size_t maxBatch = 256;
+  std::chrono::microseconds maxDelay = std::chrono::microseconds(500);
+  size_t scorers = 1;
+  // Requests beyond it are answered "error: busy"
+  size_t queueCapacity = 1 << 16;
+};
+
+/**
+ * Scores single rows sent over a Unix domain socket, in micro-batches.
+ *
+ * Clients send one row per line, as the comma separated attribute codes of
+ * the column store (a trailing class value is ignored), and get one line
+ * back per row, in order: the predicted class code, or "error: " and a
+ * reason. Requests may be pipelined on a connection.
+ *
+ * One thread owns the sockets. It parses the requests into a queue and
+ * writes the responses back. Scorer threads take the requests from the
+ * queue in batches and score a batch at once with Predictor::predict. A
+ * scorer first takes all queued requests, then waits for more until the
+ * batch holds maxBatch rows, its oldest request has waited maxDelay, or a
+ * waiting budget runs out. The budget doubles when requests came in during
+ * the wait and halves when none did. Under light load, or with clients that
+ * wait for each answer, rows are thus scored as they come, in batches of
+ * whatever queued up meanwhile; under a steady stream of requests batches
+ * fill up to amortize the dispatch.
+ *
+ * publish() swaps in a new model while the server runs. Batches that are
+ * being scored finish on the model they started with; the next batches use
+ * the new one (see RcuPointer).
+ */
+class ScoringServer {
+  public:
+    // Rows have numFeatures attributes, the same for every model published
+    ScoringServer(const std::string& socketPath, size_t numFeatures, std::unique_ptr<const Predictor> model,
+                  const ScoringOptions& options = ScoringOptions());
+    ScoringServer(const ScoringServer&) = delete;
+    ScoringServer& operator=(const ScoringServer&) = delete;
+    ~ScoringServer();
+
+    /**
+     * Serves on the calling thread until stop() is called.
+     */
+    void run();
+    void stop();
+
+    void publish(std::unique_ptr<const Predictor> model);
+    inline uint64_t version() const { return model_.version(); }
+
+    inline uint64_t requests() const { return requests_.load(); }
+    inline uint64_t batches() const { return batches_.load(); }
+
+  private:
+    struct Request {
+      uint64_t connection = 0;
+      uint64_t seq = 0;
+      int64_t arrival = 0; // steady clock, in ns
+      VecI row = {};
+    };
+
+    struct Response {
+      uint64_t connection = 0;
+      uint64_t seq = 0;
+      std::string text = {};
+    };
+
+    void score(size_t scorer);
+    void collect(std::vector<Request>& batch, int64_t& wait);
+
+    const std::string socketPath_;
+    const size_t numFeatures_;
+    const ScoringOptions options_;
+    RcuPointer<Predictor> model_;
+    BoundedQueue<Request> pending_;
+    BoundedQueue<Response> done_;
+    std::atomic<bool> stopping_;
+    std::atomic<uint64_t> requests_;
+    std::atomic<uint64_t> batches_;
+    int listener_;
+    int wakeup_; // eventfd, signaled when responses are ready or on stop
+    std::vector<std::thread> scorers_;
+};
+
+#endif //DECISIONTREE_SCORINGSERVER_HPP
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_STREAMINGPREDICTOR_HPP
+#define DECISIONTREE_STREAMINGPREDICTOR_HPP
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include "Predictor.hpp"
+#include "RowStream.hpp"
+
+/**
+ * Offline batch scoring of test files of any size.
+ *
+ * The input is read in chunks by a RowStream on a background thread while
+ * the previous chunk is scored, using two chunk buffers in turn. The
+ * predictions of every chunk are written out before its buffer is refilled,
+ * so memory use depends on the chunk size only.
+ *
+ * Every output line holds the predicted class and, optionally, the class
+ * probabilities.
+ */
+class StreamingPredictor {
+  public:
+    using Scorer = std::function<Predictions(const Data&)>;
+
+    StreamingPredictor() = delete;
+    StreamingPredictor(const Predictor& predictor, const MetaData& meta, size_t chunkRows = 65536);
+    StreamingPredictor(Scorer scorer, const MetaData& meta, size_t chunkRows = 65536);
+
+    /**
+     * Scores every row of input and returns the number of rows scored.
+     */
+    size_t run(const std::string& input, std::ostream& output, bool probabilities = false) const;
+
+  private:
+    void write(const Predictions& predictions, std::ostream& output, bool probabilities, std::string& buffer) const;
+
+    Scorer scorer_;
+    const MetaData& meta_;
+    size_t chunkRows_;
+};
+
+#endif //DECISIONTREE_STREAMINGPREDICTOR_HPP
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_THREADPOOL_HPP
+#define DECISIONTREE_THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Fixed set of worker threads executing submitted tasks in FIFO order.
+ *
+ * parallelFor lets the calling thread take part in the work, so it can be
+ * nested inside tasks that already run on the pool without deadlocking.
+ */
+class ThreadPool {
+  public:
+    // With a NUMA node given, the workers are bound to it (see Numa)
+    explicit ThreadPool(size_t threads = std::thread::hardware_concurrency(), int node = -1);
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+    ~ThreadPool();
+
+    void submit(std::function<void()> task);
+
+    /**
+     * Calls body(i) for every i in [0, n) and returns once all calls are done.
+     */
+    template<typename F>
+      void parallelFor(size_t n, F&& body) {
+        if (n == 0)
+          return;
+        if (n == 1 || workers_.empty()) {
+          for (size_t i = 0; i < n; i++)
+            body(i);
+          return;
+        }
+        auto state = std::make_shared<ForState>(n);
+        auto run = [state, &body]() {
+          size_t i;
+          while ((i = state->next.fetch_add(1)) < state->n) {
+            body(i);
+            if (state->done.fetch_add(1) + 1 == state->n) {
+              std::lock_guard<std::mutex> lock(state->mutex);
+              state->finished.notify_all();
+            }
+          }
+        };
+        const size_t helpers = std::min(n, workers_.size() + 1) - 1;
+        for (size_t h = 0; h < helpers; h++)
+          submit(run);
+        run();
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [&state]() { return state->done.load() == state->n; });
+      }
+
+    inline size_t size() const { return workers_.size(); }
+
+    /**
+     * Process-wide pool sized to the hardware concurrency.
+     */
+    static ThreadPool& shared();
+
+  private:
+    struct ForState {
+      explicit ForState(size_t count) : n(count) {}
+      const size_t n;
+      std::atomic<size_t> next{0};
+      std::atomic<size_t> done{0};
+      std::mutex mutex{};
+      std::condition_variable finished{};
+    };
+
+    void work();
+
+    std::vector<std::thread> workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable available_;
+    bool stopping_;
+};
+
+#endif //DECISIONTREE_THREADPOOL_HPP
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_TREE_HPP
+#define DECISIONTREE_TREE_HPP
+
+#include "Arena.hpp"
+#include "Leaf.hpp"
+#include "LeafProbabilities.hpp"
+#include "Node.hpp"
+#include "TreeStats.hpp"
+
+/**
+ * Storage of a single decision tree.
+ *
+ * Nodes and leaves live in per-tree monotonic arenas and refer to each other
+ * by index. Building a tree therefore never copies a subtree, and walking it
+ * involves no reference counting. Nodes can be added concurrently while
+ * subtrees are built in parallel.
+ *
+ * Once the tree is complete, the class probabilities of its leaves are
+ * computed into a contiguous pool (see LeafProbabilities), from which
+ * predictions are read as views.
+ */
+class Tree {
+  public:
+    Tree() : nodes_(), leaves_(), root_(kNoNode), stats_(), probabilities_() {}
+
+    NodeId addLeaf(const ClassCounter& counts);
+    NodeId addNode(NodeId trueBranch, NodeId falseBranch, const Question& question);
+
+    inline const Node& node(NodeId id) const { return nodes_[id]; }
+    inline const Leaf& leaf(const Node& node) const { return leaves_[node.leaf()]; }
+
+    /**
+     * Fills the probability pool from the class counts of the leaves.
+     */
+    void computeProbabilities(const OutputLayout& layout, double smoothing = 0);
+
+    /**
+     * Class probabilities of output of the given leaf node.
+     */
+    inline ProbabilityView probabilities(const Node& node, size_t output = 0) const {
+      return probabilities_.of(node.leaf(), output);
+    }
+    inline const LeafProbabilities& probabilities() const { return probabilities_; }
+
+    /**
+     * Writes the numClasses class probabilities of the given leaf node of a
+     * single-output tree to out: those of the pool, or the normalised class
+     * counts of the leaf when the pool was not computed. Throws for trees with
+     * several outputs.
+     */
+    void leafProbabilities(const Node& node, size_t numClasses, double* out) const;
+
+    inline NodeId root() const { return root_; }
+    inline void setRoot(NodeId root) { root_ = root; }
+
+    inline size_t nodeCount() const { return nodes_.size(); }
+    inline size_t leafCount() const { return leaves_.size(); }
+
+    /**
+     * Preorder listing of the questions and leaf class counts on one line,
+     * e.g. to check that two builders grew the same tree.
+     */
+    std::string toString(const MetaData& meta) const;
+
+    inline const TreeStats& stats() const { return stats_; }
+    inline void setStats(TreeStats stats) { stats_ = std::move(stats); }
+
+  private:
+    MonotonicArena<Node> nodes_;
+    MonotonicArena<Leaf> leaves_;
+    NodeId root_;
+    TreeStats stats_;
+    LeafProbabilities probabilities_;
+};
+
+#endif //DECISIONTREE_TREE_HPP
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_TREEBUILDER_HPP
+#define DECISIONTREE_TREEBUILDER_HPP
+
+#include <limits>
+#include "ColumnStore.hpp"
+#include "Tree.hpp"
+#include "TreeStats.hpp"
+
+/**
+ * Hyperparameters of tree learning.
+ */
+struct TreeParams {
+  int maxDepth = std::numeric_limits<int>::max();
+  int minSamplesSplit = 2;
+  // Levels near the root whose subtrees are built on new threads; -1 derives
+  // it from the hardware concurrency, 0 builds the tree on the calling thread.
+  int parallelDepth = -1;
+  // Levels near the root whose numeric thresholds are chosen among the values
+  // of the store's quantile sketches, when it has them. Nodes with fewer than
+  // sketchMinRows rows are searched exactly at any depth.
+  int sketchDepth = 0;
+  int sketchMinRows = 1 << 16;
+  // Laplace smoothing of the leaf probabilities, 0 for none
+  double smoothing = 0;
+  // Extremely randomized trees: one random split per feature and node is
+  // scored instead of all of them (see Calculations::find_random_split), on
+  // maxFeatures random features, all when 0.
+  bool extraTrees = false;
+  int maxFeatures = 0;
+  // Nodes with more than subsampleRows rows search their split on a sample of
+  // that many rows, stratified on class, and partition all of their rows.
+  // refineThreshold searches the threshold of the chosen feature again on all
+  // rows of the node. 0 disables subsampling.
+  int subsampleRows = 0;
+  bool refineThreshold = false;
+  // Seed of the random draws. Those of a node depend only on the seed and
+  // the path to the node, not on the thread building it.
+  uint64_t seed = 0;
+};
+
+/**
+ * Recursive CART learner on a column store.
+ *
+ * The rows of a node are given as a range of an index array, which is
+ * partitioned in place for the children. Training on a subset or a bootstrap
+ * sample of the store therefore only takes an index list.
+ *
+ * The split statistics of the tree (see TreeStats) are collected on the way
+ * and attached to the tree.
+ */
+class TreeBuilder {
+  public:
+    TreeBuilder() = delete;
+    explicit TreeBuilder(const ColumnStore& store, const TreeParams& params = TreeParams());
+
+    Tree build(VecIdx rows) const;
+
+  private:
+    NodeId buildTree(Tree& tree, TreeStats& stats, RowView rows, int depth, uint64_t seed) const;
+
+    const ColumnStore& store_;
+    TreeParams params_;
+};
+
+#endif //DECISIONTREE_TREEBUILDER_HPP
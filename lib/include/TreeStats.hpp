@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#ifndef DECISIONTREE_TREESTATS_HPP
+#define DECISIONTREE_TREESTATS_HPP
+
+#include <vector>
+#include "Node.hpp"
+#include "Utils.hpp"
+
+/**
+ * Split statistics gathered while a tree is learned.
+ *
+ * For every feature, the impurity decrease of all splits on it, weighted by
+ * the number of samples in the split node, and the number of those splits;
+ * for every node, the number of training samples that reached it. Subtrees
+ * built on other threads collect into their own instance, which is merged
+ * into the parent's when the subtree is joined.
+ */
+struct TreeStats {
+  std::vector<double> impurityDecrease = {};
+  VecI splitCount = {};
+  VecIdx nodeSamples = {}; // by NodeId
+
+  explicit TreeStats(int numFeatures = 0);
+
+  void addSplit(int feature, double gain, Idx samples);
+  void addNode(NodeId node, Idx samples);
+  void merge(const TreeStats& other);
+
+  /**
+   * Impurity decrease per feature, normalised to sum to one.
+   */
+  std::vector<double> importance() const;
+};
+
+#endif //DECISIONTREE_TREESTATS_HPP
@@ -7,7 +7,7 @@
 #ifndef DECISIONTREE_TREETEST_HPP
 #define DECISIONTREE_TREETEST_HPP
 
-#include "Node.hpp"
+#include "Tree.hpp"
 #include "Utils.hpp"
 
 using ClassCounterScaled = std::unordered_map<int, std::string>;
@@ -15,14 +15,21 @@ using ClassCounterScaled = std::unordered_map<int, std::string>;
 class TreeTest {
   public:
     TreeTest() = default;
-    TreeTest(const Data& testData, const MetaData& meta, const Node &root);
+    TreeTest(const Data& testData, const MetaData& meta, const Tree &tree);
     ~TreeTest() = default;
 
-    const ClassCounter classify(const VecI& row, std::shared_ptr<Node> node) const;
+    const ClassCounter classify(const VecI& row, const Tree& tree) const;
+
+    /**
+     * Class probabilities of output in the leaf that row ends up in, as a
+     * view into the probability pool of tree.
+     */
+    ProbabilityView predictProba(const VecI& row, const Tree& tree, size_t output = 0) const;
 
   private:
+    const Node& leafOf(const VecI& row, const Tree& tree) const;
     void printLeaf(ClassCounter counts, MetaData &meta) const;
-    void test(const Data& testing_data, const VecS& labels, std::shared_ptr<Node> tree) const;
+    void test(const Data& testing_data, const VecS& labels, const Tree& tree) const;
 };
 
 #endif //DECISIONTREE_TREETEST_HPP
@@ -8,6 +8,7 @@
 #define DECISIONTREE_UTILS_HPP
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <iterator>
 #include <map>
@@ -24,10 +25,58 @@ using VecI = std::vector<int>;
 using Data = std::vector<std::vector<int>>;
 using MapIS = std::unordered_map<int, std::string>;
 using DMapIS = std::unordered_map<std::string, MapIS>;
+using MapSI = std::unordered_map<std::string, int>;
+using DMapSI = std::unordered_map<std::string, MapSI>;
+using Idx = uint32_t;
+using VecIdx = std::vector<Idx>;
 struct MetaData {
-  VecS labels;
-  VecS types;
-  DMapIS dMapIS; // mapping of hashes to original string values
+  VecS labels = {};
+  VecS types = {};
+  DMapIS dMapIS = {}; // mapping of category codes to original string values
+  DMapSI dMapSI = {}; // mapping of original string values to category codes
+
+  // Code of value for attribute label; values not seen before get the next
+  // free code, after the ones already known
+  inline int encode(const std::string& label, const std::string& value) {
+    MapSI& codes = dMapSI[label];
+    const auto found = codes.find(value);
+    if (found != codes.end())
+      return found->second;
+    const int code = codes.size();
+    codes.emplace(value, code);
+    dMapIS[label][code] = value;
+    return code;
+  }
+};
+
+/**
+ * Non-owning view on a contiguous range of row indices.
+ */
+struct RowView {
+  Idx* first;
+  Idx* last;
+
+  inline Idx* begin() const { return first; }
+  inline Idx* end() const { return last; }
+  inline size_t size() const { return last - first; }
+};
+
+/**
+ * Non-owning view on the class probabilities of one output of a leaf.
+ */
+struct ProbabilityView {
+  const double* first;
+  const double* last;
+
+  inline const double* begin() const { return first; }
+  inline const double* end() const { return last; }
+  inline size_t size() const { return last - first; }
+  inline double operator[](size_t c) const { return first[c]; }
+
+  /**
+   * Most likely class, the lowest one on ties.
+   */
+  inline int argmax() const { return std::max_element(first, last) - first; }
 };
 
 
@@ -89,6 +138,31 @@ namespace Utils::tree {
     }
 }
 
+namespace Utils::random {
+
+  /**
+   * Well-mixed 64-bit value of seed and salt (the SplitMix64 finaliser), to
+   * derive independent seeds, e.g. per learner or per tree node.
+   */
+  inline uint64_t mix(uint64_t seed, uint64_t salt) {
+    uint64_t z = seed + 0x9e3779b97f4a7c15ULL * (salt + 1);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  /**
+   * Small, fast generator for short streams of draws, e.g. within one node.
+   */
+  struct SplitMix64 {
+    uint64_t state;
+
+    inline uint64_t next() { return mix(state++, 0); }
+    // Uniform in [0, n), for n > 0
+    inline uint64_t below(uint64_t n) { return next() % n; }
+  };
+}
+
 namespace Utils::print {
   template<typename T>
     void print_vector(const std::vector<T> &vec) {
@@ -0,0 +1,302 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <limits>
+#include <mutex>
+#include "ArffPipeline.hpp"
+#include "BoundedQueue.hpp"
+
+namespace {
+
+constexpr size_t kDone = std::numeric_limits<size_t>::max();
+
+struct Block {
+  size_t file = kDone; // kDone tells a worker to stop
+  size_t seq = 0;
+  std::string text = {};
+};
+
+struct Unknown {
+  Idx row;
+  Idx column;
+  std::string value;
+};
+
+struct Chunk {
+  size_t seq = 0;
+  Data rows = {};
+  std::vector<Unknown> unknown = {};
+};
+
+/**
+ * State shared by the stages of one run.
+ */
+struct Run {
+  Run(const std::vector<ArffPipeline::Input>& inputs, size_t workers) :
+      inputs(inputs),
+      declared(inputs.size()),
+      blocks(2 * workers),
+      chunks(),
+      window(4 * workers),
+      appended(inputs.size()),
+      total(inputs.size()),
+      readersLeft(inputs.size()),
+      failed(false),
+      errorMutex(),
+      error() {
+    for (size_t f = 0; f < inputs.size(); f++) {
+      const MetaData& meta = *inputs[f].meta;
+      for (const auto& label: meta.labels) {
+        const auto codes = meta.dMapSI.find(label);
+        declared[f].push_back(codes == meta.dMapSI.end() ? MapSI() : codes->second);
+      }
+      // A file never has more than window blocks in flight, so pushing a
+      // chunk never waits on the append stage
+      chunks.emplace_back(new BoundedQueue<Chunk>(window));
+      appended[f] = 0;
+      total[f] = kDone;
+    }
+  }
+
+  void fail() {
+    std::lock_guard<std::mutex> lock(errorMutex);
+    if (!error)
+      error = std::current_exception();
+    failed = true;
+  }
+
+  const std::vector<ArffPipeline::Input>& inputs;
+  std::vector<std::vector<MapSI>> declared;
+  BoundedQueue<Block> blocks;
+  std::vector<std::unique_ptr<BoundedQueue<Chunk>>> chunks;
+  const size_t window;
+  std::vector<std::atomic<size_t>> appended;
+  std::vector<std::atomic<size_t>> total;
+  std::atomic<size_t> readersLeft;
+  std::atomic<bool> failed;
+  std::mutex errorMutex;
+  std::exception_ptr error;
+};
+
+inline bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r';
+}
+
+void trim(const char*& begin, const char*& end) {
+  while (begin < end && isBlank(*begin))
+    ++begin;
+  while (end > begin && isBlank(end[-1]))
+    --end;
+}
+
+/**
+ * I/O stage: cuts the data section of a file into blocks of whole lines.
+ */
+void readBlocks(Run& run, size_t f, size_t blockSize, size_t workers) {
+  try {
+    const ArffPipeline::Input& input = run.inputs[f];
+    std::ifstream file(input.filename, std::ios::binary);
+    if (!file)
+      throw std::runtime_error("Can't open file: " + input.filename);
+    file.seekg(input.dataStart);
+
+    std::string carry;
+    size_t seq = 0;
+    while (file && !run.failed) {
+      Block block;
+      block.file = f;
+      block.seq = seq;
+      block.text.resize(carry.size() + blockSize);
+      std::memcpy(&block.text[0], carry.data(), carry.size());
+      file.read(&block.text[carry.size()], blockSize);
+      block.text.resize(carry.size() + file.gcount());
+      carry.clear();
+      if (file) {
+        const size_t lineEnd = block.text.rfind('\n');
+        if (lineEnd == std::string::npos) {
+          carry.swap(block.text);
+          continue;
+        }
+        carry.assign(block.text, lineEnd + 1, std::string::npos);
+        block.text.resize(lineEnd + 1);
+      }
+      if (block.text.empty())
+        break;
+
+      const bool inWindow = BoundedQueue<Block>::waitFor([&]() {
+        return seq < run.appended[f].load(std::memory_order_acquire) + run.window;
+      }, run.failed);
+      if (!inWindow || !run.blocks.push(block, run.failed))
+        break;
+      seq++;
+    }
+    run.total[f].store(seq, std::memory_order_release);
+  } catch (...) {
+    run.fail();
+  }
+
+  // The last reader to finish stops the workers
+  if (run.readersLeft.fetch_sub(1) == 1) {
+    for (size_t w = 0; w < workers; w++) {
+      Block done;
+      if (!run.blocks.push(done, run.failed))
+        break;
+    }
+  }
+}
+
+/**
+ * Tokenize stage: turns a block into typed rows.
+ */
+void parseBlock(Run& run, const Block& block, Chunk& chunk) {
+  const ArffPipeline::Input& input = run.inputs[block.file];
+  const MetaData& meta = *input.meta;
+  const std::vector<MapSI>& declared = run.declared[block.file];
+  const size_t columns = input.fieldOf.size();
+
+  thread_local std::vector<std::pair<const char*, const char*>> fields;
+  thread_local std::string key;
+
+  chunk.seq = block.seq;
+  const char* p = block.text.data();
+  const char* const end = p + block.text.size();
+  while (p < end) {
+    const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    if (lineEnd == nullptr)
+      lineEnd = end;
+    const char* first = p;
+    const char* last = lineEnd;
+    p = lineEnd + 1;
+    trim(first, last);
+    if (first == last || *first == '%')
+      continue;
+
+    fields.clear();
+    for (const char* field = first; ; ) {
+      const char* comma = static_cast<const char*>(std::memchr(field, ',', last - field));
+      const char* fieldEnd = comma == nullptr ? last : comma;
+      const char* b = field;
+      const char* e = fieldEnd;
+      trim(b, e);
+      fields.emplace_back(b, e);
+      if (comma == nullptr)
+        break;
+      field = comma + 1;
+    }
+    if (fields.size() != columns)
+      throw std::runtime_error("Expected " + std::to_string(columns) + " values in "
+          + input.filename + ": " + std::string(first, last));
+
+    VecI row(columns);
+    for (size_t c = 0; c < columns; c++) {
+      const auto& field = fields[input.fieldOf[c]];
+      if (meta.types[c] == "NUMERIC") {
+        // Truncated to an integer
+        char* parsed = nullptr;
+        const double value = field.first == field.second ? 0 : std::strtod(field.first, &parsed);
+        if (parsed == nullptr || parsed == field.first || parsed > field.second)
+          throw std::runtime_error("Invalid numeric value in " + input.filename
+              + ": " + std::string(field.first, field.second));
+        row[c] = value;
+      } else if (meta.types[c] == "CATEGORICAL") {
+        key.assign(field.first, field.second);
+        const auto found = declared[c].find(key);
+        if (found != declared[c].end()) {
+          row[c] = found->second;
+        } else {
+          row[c] = -1;
+          chunk.unknown.push_back({(Idx) chunk.rows.size(), (Idx) c, key});
+        }
+      } else {
+        throw std::runtime_error("Attribute type is neither NUMERICAL nor CATEGORICAL.");
+      }
+    }
+    chunk.rows.push_back(std::move(row));
+  }
+}
+
+void parseBlocks(Run& run) {
+  try {
+    while (true) {
+      Block block;
+      if (!run.blocks.pop(block, run.failed) || block.file == kDone)
+        return;
+      Chunk chunk;
+      parseBlock(run, block, chunk);
+      if (!run.chunks[block.file]->push(chunk, run.failed))
+        return;
+    }
+  } catch (...) {
+    run.fail();
+  }
+}
+
+/**
+ * Append stage: adds the rows of a file's blocks to its data in file order.
+ */
+void appendChunks(Run& run, size_t f) {
+  try {
+    const ArffPipeline::Input& input = run.inputs[f];
+    std::map<size_t, Chunk> pending;
+    size_t next = 0;
+    while (true) {
+      Chunk chunk;
+      bool finished = false;
+      const bool ok = BoundedQueue<Chunk>::waitFor([&]() {
+        if (run.chunks[f]->tryPop(chunk))
+          return true;
+        finished = next == run.total[f].load(std::memory_order_acquire);
+        return finished;
+      }, run.failed);
+      if (!ok || finished)
+        return;
+
+      const size_t seq = chunk.seq;
+      pending.emplace(seq, std::move(chunk));
+      for (auto it = pending.find(next); it != pending.end(); it = pending.find(next)) {
+        Chunk& ready = it->second;
+        for (const auto& unknown: ready.unknown)
+          ready.rows[unknown.row][unknown.column] =
+            input.meta->encode(input.meta->labels[unknown.column], unknown.value);
+        input.data->insert(input.data->end(),
+            std::make_move_iterator(ready.rows.begin()), std::make_move_iterator(ready.rows.end()));
+        pending.erase(it);
+        run.appended[f].store(++next, std::memory_order_release);
+      }
+    }
+  } catch (...) {
+    run.fail();
+  }
+}
+
+}
+
+ArffPipeline::ArffPipeline(size_t workers, size_t blockSize) :
+    workers_(std::max<size_t>(workers, 1)),
+    blockSize_(std::max<size_t>(blockSize, 1)) {
+}
+
+void ArffPipeline::run(const std::vector<Input>& inputs) const {
+  if (inputs.empty())
+    return;
+
+  Run run(inputs, workers_);
+  std::vector<std::thread> threads;
+  for (size_t f = 0; f < inputs.size(); f++) {
+    threads.emplace_back(readBlocks, std::ref(run), f, blockSize_, workers_);
+    threads.emplace_back(appendChunks, std::ref(run), f);
+  }
+  for (size_t w = 0; w < workers_; w++)
+    threads.emplace_back(parseBlocks, std::ref(run));
+  for (auto& thread: threads)
+    thread.join();
+
+  if (run.error)
+    std::rethrow_exception(run.error);
+}
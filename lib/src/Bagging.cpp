@@ -5,16 +5,16 @@
  */
 
 #include "Bagging.hpp"
+#include "FeatureImportance.hpp"
 
-using std::make_shared;
-using std::shared_ptr;
 using std::string;
 using boost::timer::cpu_timer;
 
-Bagging::Bagging(const DataReader& dr, const int ensembleSize, uint seed) : 
+Bagging::Bagging(const DataReader& dr, const int ensembleSize, uint seed, const TreeParams& params) : 
   dr_(dr), 
   ensembleSize_(ensembleSize),
-  learners_({}) {
+  params_(params),
+  learners_() {
   random_number_generator.seed(seed);
   buildBag();
 }
@@ -25,18 +25,20 @@ void Bagging::buildBag() {
   std::vector<double> timings;
   int N = dr_.trainData().size();
   std::uniform_int_distribution<int> unii(0, N-1);
+  learners_.reserve(ensembleSize_);
   for (int i = 0; i < ensembleSize_; i++) {
     timer.start();
-    Data data;
+    std::vector<size_t> samples;
+    samples.reserve(N);
     int count = N;
     while(count-- > 0){
-      data.emplace_back(dr_.trainData()[unii(random_number_generator)]);
+      samples.push_back(unii(random_number_generator));
     }
-    dr_.setBaggingData(data);
-    DecisionTree dt(dr_);
-    //dt.print();
-    learners_.push_back(dt);
-    dr_.resetBaggingData();
+    // Every learner draws its random splits from its own seed
+    TreeParams params = params_;
+    params.seed = Utils::random::mix(params_.seed, i);
+    learners_.emplace_back(dr_, samples, params);
+    //learners_.back().print();
     auto nanoseconds = boost::chrono::nanoseconds(timer.elapsed().wall);
     auto seconds = boost::chrono::duration_cast<boost::chrono::seconds>(nanoseconds);
     timings.push_back(seconds.count());
@@ -46,21 +48,33 @@ void Bagging::buildBag() {
 }
 
 void Bagging::test() const {
-  TreeTest t;
-  float accuracy = 0;
-  for (const auto& row: dr_.testData()) {
-    static size_t last = row.size() - 1;
-    std::vector<int> decisions;
-    for (int i = 0; i < ensembleSize_; i++) {
-      const std::shared_ptr<Node> root = std::make_shared<Node>(learners_.at(i).root_);
-      const auto& classification = t.classify(row, root);
-      decisions.push_back(Utils::tree::getMax(classification));
+  const Predictions predictions = Predictor(*this).predict(dr_.testData());
+  std::cout << "Total accuracy: " << predictions.accuracy(dr_.testData()) << std::endl;
+}
+
+TreeStats Bagging::stats() const {
+  TreeStats total(dr_.columns().numFeatures());
+  for (const auto& learner: learners_) {
+    const TreeStats& stats = learner.stats();
+    for (size_t f = 0; f < stats.impurityDecrease.size(); f++) {
+      total.impurityDecrease[f] += stats.impurityDecrease[f];
+      total.splitCount[f] += stats.splitCount[f];
     }
-    int prediction = Utils::iterators::mostCommon(decisions.begin(), decisions.end());
-    if (prediction == row[last])
-      accuracy += 1;
   }
-  std::cout << "Total accuracy: " << (accuracy / dr_.testData().size()) << std::endl;
+  return total;
+}
+
+std::vector<const Tree*> Bagging::trees() const {
+  std::vector<const Tree*> trees;
+  for (const auto& learner: learners_)
+    trees.push_back(&learner.tree());
+  return trees;
 }
 
+std::vector<double> Bagging::featureImportance() const {
+  return FeatureImportance::impurity(trees(), dr_.columns().numFeatures());
+}
 
+std::vector<double> Bagging::permutationImportance(const Data& data, int repeats, uint seed) const {
+  return FeatureImportance::permutation(Predictor(*this), data, repeats, seed);
+}
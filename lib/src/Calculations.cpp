@@ -7,7 +7,9 @@
 #include <cmath>
 #include <algorithm>
 #include <iterator>
+#include "Arena.hpp"
 #include "Calculations.hpp"
+#include "Numa.hpp"
 #include "Utils.hpp"
 
 using std::tuple;
@@ -17,42 +19,125 @@ using std::vector;
 using std::string;
 using std::unordered_map;
 
-tuple<Data, Data> Calculations::partition(const Data& data, const Question& q) {
-  Data true_rows;
-  Data false_rows;
-  
-  for (const auto &row: data) {
-    if (q.solve(row))
-      true_rows.push_back(row);
-    else
-      false_rows.push_back(row);
-  }
+namespace {
+
+// Nodes holding more than a 1/log2(n) fraction of the data set read the
+// order of numeric columns from the presorted index of the store, which
+// costs one pass over all rows, instead of sorting their own rows.
+bool usePresorted(size_t nodeSize, size_t numRows) {
+  return nodeSize * std::log2(std::max<size_t>(nodeSize, 2)) > numRows;
+}
+
+// Nodes with at least this many rows search their features in parallel
+constexpr size_t kParallelSplitRows = size_t(1) << 16;
+
+}
 
-  return forward_as_tuple(true_rows, false_rows);
+tuple<RowView, RowView> Calculations::partition(const ColumnStore& store, RowView rows, const Question& q) {
+  Idx* middle;
+  if (store.isSparse(q.column_)) {
+    middle = std::partition(rows.begin(), rows.end(), [&](Idx r) {
+      return q.matches(store.value(q.column_, r));
+    });
+  } else {
+    const VecI& column = store.column(q.column_);
+    middle = std::partition(rows.begin(), rows.end(), [&](Idx r) {
+      return q.matches(column[r]);
+    });
+  }
+  return forward_as_tuple(RowView{rows.begin(), middle}, RowView{middle, rows.end()});
 }
 
-tuple<const double, const Question> Calculations::find_best_split(const Data& rows, const MetaData& meta) {
+tuple<const double, const Question> Calculations::find_best_split(const ColumnStore& store, RowView rows, bool approximate) {
   double best_gain = 0.0;  // keep track of the best information gain
   Question best_question;  // keep track of the feature / value that produced it
-  ClassCounter clsCounter = classCounts(rows);
-  double gini_node = gini(clsCounter, rows.size());
-  // Best split for each feature
-  for(int f=0; f<meta.labels.size()-1; f++){
-    tuple<int, double> best_threshold;
-    if (meta.types[f] == "NUMERIC"){
-      best_threshold = determine_best_threshold_numeric(rows, f);
-    }
-    else if(meta.types[f] == "CATEGORICAL"){
-      best_threshold = determine_best_threshold_cat(rows, f);
-    }
-    else {
-      throw std::runtime_error("Attribute type is neither NUMERICAL nor CATEGORICAL.");
-    }
-    // Calculate best_threshold gain
-    double gain = gini_node - std::get<1>(best_threshold);
-    if(gain > best_gain){
+  const MetaData& meta = store.meta();
+  ScratchBuffer<int> clsTally(store.numClasses(), 0);
+  classTally(store, rows, *clsTally);
+  double gini_node = gini(*clsTally, rows.size());
+  ScratchBuffer<int> subset;
+  // Multiplicity of every row of the store in this node, for the presorted path
+  ScratchBuffer<int> multiplicity;
+  // Sketched features do not need the presorted index, sparse ones still do
+  const bool presorted = (!approximate || store.hasSparse()) && usePresorted(rows.size(), store.numRows());
+  if (presorted) {
+    multiplicity->assign(store.numRows(), 0);
+    for (const Idx r: rows)
+      (*multiplicity)[r]++;
+  }
+  // Sparse features are scanned together, over their non-zero entries only
+  if (store.hasSparse()) {
+    tuple<int, int, double> best_sparse = determine_best_threshold_sparse(store, rows, *clsTally, presorted ? multiplicity->data() : nullptr);
+    double gain = gini_node - std::get<2>(best_sparse);
+    if(std::get<0>(best_sparse) >= 0 && gain > best_gain){
+      best_gain = gain;
+      best_question = Question(std::get<0>(best_sparse), std::get<1>(best_sparse), meta);
+    }
+  }
+  if (rows.size() >= kParallelSplitRows && store.numFeatures() > 1) {
+    // Features are scanned in parallel, each on the NUMA node owning its column
+    const VecI& features = store.features();
+    vector<double> gains(store.numFeatures(), 0.0);
+    VecI thresholds(store.numFeatures(), 0);
+    vector<VecI> subsets(store.numFeatures());
+    NumaPools::shared().parallelFor(features.size(), [&](size_t i) { return store.columnNode(features[i]); }, [&](size_t i) {
+      const int f = features[i];
+      if (store.isSparse(f)) {
+        return;
+      } else if (store.isNumeric(f)) {
+        double loss;
+        std::tie(thresholds[f], loss) = approximate
+          ? determine_best_threshold_sketch(store, rows, f)
+          : determine_best_threshold_numeric(store, rows, f, presorted ? multiplicity->data() : nullptr);
+        gains[f] = gini_node - loss;
+      } else {
+        gains[f] = gini_node - determine_best_subset_cat(store, rows, f, subsets[f]);
+      }
+    });
+    int best_feature = -1;
+    for(const int f: features){
+      if(gains[f] > best_gain){
+        best_gain = gains[f];
+        best_feature = f;
+      }
+    }
+    if (best_feature >= 0)
+      best_question = store.isNumeric(best_feature) ? Question(best_feature, thresholds[best_feature], meta) : Question(best_feature, subsets[best_feature], meta);
+  } else {
+    // Best split for each dense feature
+    for(const int f: store.features()){
+      if (store.isSparse(f)){
+        continue;
+      }
+      else if (store.isNumeric(f)){
+        tuple<int, double> best_threshold = approximate
+          ? determine_best_threshold_sketch(store, rows, f)
+          : determine_best_threshold_numeric(store, rows, f, presorted ? multiplicity->data() : nullptr);
+        // Calculate best_threshold gain
+        double gain = gini_node - std::get<1>(best_threshold);
+        if(gain > best_gain){
+          best_gain = gain;
+          best_question = Question(f, std::get<0>(best_threshold), meta);
+        }
+      }
+      else {
+        double gain = gini_node - determine_best_subset_cat(store, rows, f, *subset);
+        if(gain > best_gain){
+          best_gain = gain;
+          best_question = Question(f, *subset, meta);
+        }
+      }
+    }
+  }
+  // Bundled features, over the non-zero entries of each bundle. Ties go to the
+  // lowest feature, as when every feature is scanned in order
+  for(size_t b=0; b<store.numBundles(); b++){
+    tuple<int, int, double> best_bundled = determine_best_threshold_bundle(store, rows, b, *clsTally, presorted ? multiplicity->data() : nullptr);
+    const int f = std::get<0>(best_bundled);
+    double gain = gini_node - std::get<2>(best_bundled);
+    if(f >= 0 && (gain > best_gain || (gain == best_gain && gain > 0 && f < best_question.column_))){
       best_gain = gain;
-      best_question = Question(f, std::get<0>(best_threshold), meta);
+      best_question = Question(f, std::get<1>(best_bundled), meta);
     }
   }
   return forward_as_tuple(best_gain, best_question);
@@ -66,97 +151,421 @@ const double Calculations::gini(const ClassCounter& counts, double N) {
   return impurity;
 }
 
-tuple<int, double> Calculations::determine_best_threshold_numeric(const Data& data, int col) {
-  Data fData;
+const double Calculations::gini(const ClassTally& tally, double N) {
+  double impurity = 1.0;
+  for(const int value: tally){
+    impurity -= pow(value/N, 2);
+  }
+  return impurity;
+}
+
+tuple<int, double> Calculations::determine_best_threshold_numeric(const ColumnStore& store, RowView rows, int col, const int* multiplicity) {
+  ScratchBuffer<pair<int, int>> fData;
   double best_loss = std::numeric_limits<float>::infinity();
-  int N = data.size();
-  int m = data[0].size();
-  int best_thresh;
-  // Construct the subset of feature and class columns
-  for(int i=0; i<N; i++){
-    fData.push_back({data[i][col], data[i][m-1]});
-  };
-  // Sort based on ordinal feature
-  std::sort(fData.begin(), fData.end(), [](VecI& a, VecI& b) {
-    return a[0] < b[0];
-  });
+  int N = rows.size();
+  int numClasses = store.numClasses();
+  int best_thresh = 0;
+  const VecI& column = store.column(col);
+  const VecI& labels = store.labels();
+  // Construct the subset of feature and class columns, sorted on the feature
+  if (multiplicity) {
+    for(const Idx r: store.sortedRows(col)){
+      for(int k=0; k<multiplicity[r]; k++)
+        fData->emplace_back(column[r], labels[r]);
+    }
+  } else {
+    for(const Idx r: rows){
+      fData->emplace_back(column[r], labels[r]);
+    };
+    std::sort(fData->begin(), fData->end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+      return a.first < b.first;
+    });
+  }
   // Initialize class counters
-  ClassCounter clsCntTrue, clsCntFalse;
-  clsCntTrue = classCounts(fData);
+  ScratchBuffer<int> clsCntTrue(numClasses, 0), clsCntFalse(numClasses, 0);
+  for(const auto& [value, decision]: *fData){
+    (*clsCntTrue)[decision]++;
+  }
 
   // Update class counters and compute gini
   int nTrue = N;
   for(int i=0; i<N-1; i++){
     nTrue--;
-    int decision = fData[i][1];
-    clsCntTrue.at(decision)--;
-    if (clsCntFalse.find(decision) != std::end(clsCntFalse)) {
-      clsCntFalse.at(decision)++;
-    } else {
-      clsCntFalse[decision] += 1;
-    }
+    int decision = (*fData)[i].second;
+    (*clsCntTrue)[decision]--;
+    (*clsCntFalse)[decision]++;
 
-    if(fData[i][0] < fData[i+1][0]){
+    if((*fData)[i].first < (*fData)[i+1].first){
       int nFalse = N - nTrue;
-      double gini_true = gini(clsCntTrue, nTrue);
-      double gini_false = gini(clsCntFalse, nFalse);
+      double gini_true = gini(*clsCntTrue, nTrue);
+      double gini_false = gini(*clsCntFalse, nFalse);
       double gini_part = gini_true*((double) nTrue/N) + gini_false*((double) nFalse/N);
       if(gini_part < best_loss){
         best_loss = gini_part;
-        best_thresh = fData[i+1][0];
+        best_thresh = (*fData)[i+1].first;
       }
     }
   }
   return forward_as_tuple(best_thresh, best_loss);
 }
 
-tuple<int, double> Calculations::determine_best_threshold_cat(const Data& data, int col) {
-  double best_loss = std::numeric_limits<float>::infinity();
-  int best_thresh;
-  int N = data.size();
-  int lastIdx = data[0].size()-1;
-  // Initialize class counters
-  ClassCounter counterTrue;
-  ClassCounter counterFalse = classCounts(data);;
-  std::unordered_map<int, ClassCounter> mapOfCountersTrue;
-  std::unordered_map<int, ClassCounter> mapOfCountersFalse;
-  for(int i=0; i<N; i++){
-    int decision = data[i][lastIdx];
-    // Check (create) class counter for true set
-    if(mapOfCountersTrue.find(data[i][col]) == std::end(mapOfCountersTrue)){
-      mapOfCountersTrue[data[i][col]] = counterTrue;
-    }
-    // Check (create) class counter for false set
-    if(mapOfCountersFalse.find(data[i][col]) == std::end(mapOfCountersFalse)){
-      mapOfCountersFalse[data[i][col]] = counterFalse;
-    }
-    // Update
-    mapOfCountersFalse.at(data[i][col]).at(decision)--;
-    if (mapOfCountersTrue.at(data[i][col]).find(decision) != std::end(mapOfCountersTrue.at(data[i][col]))) {
-      mapOfCountersTrue.at(data[i][col]).at(decision)++;
-    } else {
-      mapOfCountersTrue.at(data[i][col])[decision] += 1;
+tuple<int, double> Calculations::determine_best_threshold_sketch(const ColumnStore& store, RowView rows, int col) {
+  const VecI& candidates = store.sketchValues(col);
+  const std::vector<uint16_t>& rowBins = store.sketchBins(col);
+  const VecI& labels = store.labels();
+  const int numClasses = store.numClasses();
+  // Class counts per bin, from the bins the store assigned to the rows
+  ScratchBuffer<int> bins((candidates.size() + 1) * numClasses, 0);
+  for(const Idx r: rows){
+    (*bins)[rowBins[r] * numClasses + labels[r]]++;
+  }
+  return determine_best_threshold_binned(bins->data(), candidates, numClasses);
+}
+
+tuple<int, double> Calculations::determine_best_threshold_binned(const int* bins, const VecI& cuts, int numClasses) {
+  ScratchBuffer<int> clsCntTrue(numClasses, 0), clsCntFalse(numClasses, 0);
+  int N = 0;
+  for(size_t b=0; b<=cuts.size(); b++){
+    for(int k=0; k<numClasses; k++){
+      N += bins[b * numClasses + k];
+      (*clsCntTrue)[k] += bins[b * numClasses + k];
     }
   }
 
-  // Compute gini for each value
-  for(const auto& n: mapOfCountersTrue) {
-    int nTrue = 0;
-    for(const auto& m: mapOfCountersTrue.at(n.first)) {
-      nTrue += m.second;
+  // Threshold cuts[b] sends bins 0..b to the false side
+  double best_loss = std::numeric_limits<float>::infinity();
+  int best_thresh = 0;
+  int nTrue = N;
+  for(size_t b=0; b<cuts.size(); b++){
+    const int* bin = bins + b * numClasses;
+    for(int k=0; k<numClasses; k++){
+      nTrue -= bin[k];
+      (*clsCntTrue)[k] -= bin[k];
+      (*clsCntFalse)[k] += bin[k];
     }
     int nFalse = N - nTrue;
-    double gini_true = gini(n.second, nTrue);
-    double gini_false = gini(mapOfCountersFalse.at(n.first), nFalse);
+    if(nTrue == 0)
+      break;
+    if(nFalse == 0)
+      continue;
+    double gini_true = gini(*clsCntTrue, nTrue);
+    double gini_false = gini(*clsCntFalse, nFalse);
     double gini_part = gini_true*((double) nTrue/N) + gini_false*((double) nFalse/N);
     if(gini_part < best_loss){
       best_loss = gini_part;
-      best_thresh = n.first;
+      best_thresh = cuts[b];
     }
   }
   return forward_as_tuple(best_thresh, best_loss);
 }
 
+namespace {
+
+struct SparseEntry {
+  Idx feature;
+  int value;
+  int label;
+};
+
+}
+
+tuple<int, int, double> Calculations::determine_best_threshold_sparse(const ColumnStore& store, RowView rows, const ClassTally& tally, const int* multiplicity) {
+  ScratchBuffer<SparseEntry> entries;
+  const VecI& labels = store.labels();
+  // Gather the non-zero entries of the node, sorted on feature and value
+  if (multiplicity) {
+    const VecIdx& colRows = store.sparseColumnRows();
+    const VecI& colValues = store.sparseColumnValues();
+    for(int f=0; f<store.numFeatures(); f++){
+      if (!store.isSparse(f))
+        continue;
+      for(size_t i=store.sparseColumnBegin(f); i<store.sparseColumnEnd(f); i++){
+        const Idx r = colRows[i];
+        for(int k=0; k<multiplicity[r]; k++)
+          entries->push_back({Idx(f), colValues[i], labels[r]});
+      }
+    }
+  } else {
+    const SparseMatrix& csr = store.sparseRows();
+    for(const Idx r: rows){
+      for(size_t i=csr.rowStart[r]; i<csr.rowStart[r+1]; i++)
+        entries->push_back({csr.feature[i], csr.value[i], labels[r]});
+    }
+    std::sort(entries->begin(), entries->end(), [](const SparseEntry& a, const SparseEntry& b) {
+      return a.feature < b.feature || (a.feature == b.feature && a.value < b.value);
+    });
+  }
+
+  const int N = rows.size();
+  const int numClasses = store.numClasses();
+  double best_loss = std::numeric_limits<float>::infinity();
+  int best_feature = -1, best_thresh = 0;
+  ScratchBuffer<int> clsCntTrue(numClasses, 0), clsCntFalse(numClasses, 0), zeroTally(numClasses, 0);
+  // Features without non-zero entries in the node are constant and skipped;
+  // for the others the implicit zeros are handled as a single block
+  for(size_t begin=0, end=0; begin<entries->size(); begin=end){
+    const SparseEntry* group = entries->data() + begin;
+    end = begin;
+    while(end < entries->size() && (*entries)[end].feature == group->feature)
+      end++;
+    const size_t nonZeros = end - begin;
+    const int zeros = N - nonZeros;
+    std::copy(tally.begin(), tally.end(), zeroTally->begin());
+    for(size_t i=0; i<nonZeros; i++)
+      (*zeroTally)[group[i].label]--;
+    std::copy(tally.begin(), tally.end(), clsCntTrue->begin());
+    std::fill(clsCntFalse->begin(), clsCntFalse->end(), 0);
+
+    // Items in ascending order: the negative entries, the block of zeros and
+    // the remaining entries
+    const size_t block = std::lower_bound(group, group + nonZeros, 0, [](const SparseEntry& e, int v) {
+      return e.value < v;
+    }) - group;
+    const size_t hasBlock = zeros > 0 ? 1 : 0;
+    const size_t items = nonZeros + hasBlock;
+    auto valueOf = [&](size_t k) {
+      if (k < block) return group[k].value;
+      if (hasBlock && k == block) return 0;
+      return group[k - hasBlock].value;
+    };
+
+    int nTrue = N;
+    for(size_t k=0; k+1<items; k++){
+      if (hasBlock && k == block) {
+        nTrue -= zeros;
+        for(int c=0; c<numClasses; c++){
+          (*clsCntTrue)[c] -= (*zeroTally)[c];
+          (*clsCntFalse)[c] += (*zeroTally)[c];
+        }
+      } else {
+        const int decision = group[k < block ? k : k - hasBlock].label;
+        nTrue--;
+        (*clsCntTrue)[decision]--;
+        (*clsCntFalse)[decision]++;
+      }
+      const int next = valueOf(k+1);
+      if(valueOf(k) < next){
+        int nFalse = N - nTrue;
+        double gini_true = gini(*clsCntTrue, nTrue);
+        double gini_false = gini(*clsCntFalse, nFalse);
+        double gini_part = gini_true*((double) nTrue/N) + gini_false*((double) nFalse/N);
+        if(gini_part < best_loss){
+          best_loss = gini_part;
+          best_feature = group->feature;
+          best_thresh = next;
+        }
+      }
+    }
+  }
+  return forward_as_tuple(best_feature, best_thresh, best_loss);
+}
+
+tuple<int, int, double> Calculations::determine_best_threshold_bundle(const ColumnStore& store, RowView rows, size_t b, const ClassTally& tally, const int* multiplicity) {
+  const FeatureBundle& bundle = store.bundle(b);
+  const VecI& column = bundle.column;
+  const VecI& labels = store.labels();
+  ScratchBuffer<pair<int, int>> entries;
+  // Gather the non-zero entries of the node, sorted on the bundle column, so
+  // that the entries of every member are contiguous and sorted on its value
+  if (multiplicity) {
+    for(const Idx r: bundle.nonZeroRows){
+      for(int k=0; k<multiplicity[r]; k++)
+        entries->emplace_back(column[r], labels[r]);
+    }
+  } else {
+    for(const Idx r: rows){
+      if(column[r] != 0)
+        entries->emplace_back(column[r], labels[r]);
+    }
+    std::sort(entries->begin(), entries->end(), [](const pair<int, int>& a, const pair<int, int>& b) {
+      return a.first < b.first;
+    });
+  }
+
+  const int N = rows.size();
+  const int numClasses = store.numClasses();
+  double best_loss = std::numeric_limits<float>::infinity();
+  int best_feature = -1, best_thresh = 0;
+  ScratchBuffer<int> clsCntTrue(numClasses, 0), clsCntFalse(numClasses, 0);
+  size_t end = 0;
+  for(size_t j=0; j<bundle.members.size(); j++){
+    const size_t begin = end;
+    while(end < entries->size() && (*entries)[end].first <= bundle.offsets[j+1])
+      end++;
+    if(begin == end)
+      continue;
+    const pair<int, int>* group = entries->data() + begin;
+    const int nonZeros = end - begin;
+    const int offset = bundle.offsets[j];
+    // The rows where the member is zero, those of the other members included,
+    // come first in its order; the non-zero entries are the true side of the
+    // first threshold
+    std::fill(clsCntTrue->begin(), clsCntTrue->end(), 0);
+    for(int i=0; i<nonZeros; i++)
+      (*clsCntTrue)[group[i].second]++;
+    for(int c=0; c<numClasses; c++)
+      (*clsCntFalse)[c] = tally[c] - (*clsCntTrue)[c];
+    int nTrue = nonZeros;
+    auto evaluate = [&](int threshold) {
+      int nFalse = N - nTrue;
+      double gini_true = gini(*clsCntTrue, nTrue);
+      double gini_false = gini(*clsCntFalse, nFalse);
+      double gini_part = gini_true*((double) nTrue/N) + gini_false*((double) nFalse/N);
+      if(gini_part < best_loss){
+        best_loss = gini_part;
+        best_feature = bundle.members[j];
+        best_thresh = threshold;
+      }
+    };
+    if(nonZeros < N)
+      evaluate(group[0].first - offset);
+    for(int i=0; i<nonZeros-1; i++){
+      nTrue--;
+      (*clsCntTrue)[group[i].second]--;
+      (*clsCntFalse)[group[i].second]++;
+      if(group[i].first < group[i+1].first)
+        evaluate(group[i+1].first - offset);
+    }
+  }
+  return forward_as_tuple(best_feature, best_thresh, best_loss);
+}
+
+namespace {
+
+// Categorical attributes with at most this many values present in a node are
+// split by trying every subset; above it, multiclass targets fall back to the
+// ordering heuristic below.
+constexpr int kMaxExhaustiveCategories = 10;
+
+// Weighted gini of the partition induced by the class counts of the true
+// branch, given the class counts of the whole node.
+double giniPartition(const ClassTally& counterTrue, const ClassTally& counterAll, ClassTally& counterFalse, int nTrue, int N) {
+  for(size_t c=0; c<counterAll.size(); c++)
+    counterFalse[c] = counterAll[c] - counterTrue[c];
+  int nFalse = N - nTrue;
+  double gini_true = Calculations::gini(counterTrue, nTrue);
+  double gini_false = Calculations::gini(counterFalse, nFalse);
+  return gini_true*((double) nTrue/N) + gini_false*((double) nFalse/N);
+}
+
+}
+
+double Calculations::determine_best_subset_cat(const ColumnStore& store, RowView rows, int col, VecI& subset) {
+  int numCategories = store.numCategories(col);
+  int numClasses = store.numClasses();
+  const VecI& column = store.column(col);
+  const VecI& labels = store.labels();
+  // Class counters, one row of numClasses counts per category
+  ScratchBuffer<int> countersCat(numCategories * numClasses, 0);
+  for(const Idx r: rows){
+    (*countersCat)[column[r] * numClasses + labels[r]]++;
+  }
+  return determine_best_subset_counts(countersCat->data(), numCategories, numClasses, subset);
+}
+
+double Calculations::determine_best_subset_counts(const int* countersCat, int numCategories, int numClasses, VecI& subset) {
+  double best_loss = std::numeric_limits<float>::infinity();
+  int N = 0;
+  subset.clear();
+  ScratchBuffer<int> sizes(numCategories, 0);
+  ScratchBuffer<int> counterAll(numClasses, 0);
+  for(int value=0; value<numCategories; value++){
+    for(int c=0; c<numClasses; c++){
+      const int count = countersCat[value * numClasses + c];
+      (*sizes)[value] += count;
+      (*counterAll)[c] += count;
+      N += count;
+    }
+  }
+  ScratchBuffer<int> present;
+  for(int value=0; value<numCategories; value++)
+    if((*sizes)[value] > 0)
+      present->push_back(value);
+  const int m = present->size();
+  if(m < 2)
+    return best_loss;
+
+  ScratchBuffer<int> counterTrue(numClasses, 0), counterFalse(numClasses, 0);
+  auto add = [&](int value, int sign) {
+    for(int c=0; c<numClasses; c++)
+      (*counterTrue)[c] += sign * countersCat[value * numClasses + c];
+    return sign * (*sizes)[value];
+  };
+
+  if(numClasses > 2 && m <= kMaxExhaustiveCategories){
+    // Enumerate all subsets that leave the first present value in the false
+    // branch, in Gray code order so each step moves a single category.
+    uint32_t mask = 0, best_mask = 0;
+    int nTrue = 0;
+    for(uint32_t i=1; i < (uint32_t(1) << (m-1)); i++){
+      const int bit = __builtin_ctz(i);
+      mask ^= uint32_t(1) << bit;
+      nTrue += add((*present)[bit+1], (mask >> bit) & 1 ? 1 : -1);
+      double gini_part = giniPartition(*counterTrue, *counterAll, *counterFalse, nTrue, N);
+      if(gini_part < best_loss){
+        best_loss = gini_part;
+        best_mask = mask;
+      }
+    }
+    for(int bit=0; bit<m-1; bit++)
+      if((best_mask >> bit) & 1)
+        subset.push_back((*present)[bit+1]);
+    return best_loss;
+  }
+
+  // Sort the values on the proportion of one class and try every prefix of
+  // that ordering. For two classes this is exact [Bre84, Sec 9.4]; for more
+  // classes it is repeated for every class and complemented with all
+  // one-vs-rest splits.
+  ScratchBuffer<int> order;
+  int best_class = -1, best_prefix = 0;
+  for(int target=(numClasses > 2 ? 0 : 1); target<numClasses; target++){
+    order->assign(present->begin(), present->end());
+    std::sort(order->begin(), order->end(), [&](int a, int b) {
+      const int64_t pa = int64_t(countersCat[a * numClasses + target]) * (*sizes)[b];
+      const int64_t pb = int64_t(countersCat[b * numClasses + target]) * (*sizes)[a];
+      return pa < pb || (pa == pb && a < b);
+    });
+    std::fill(counterTrue->begin(), counterTrue->end(), 0);
+    int nTrue = 0;
+    for(int prefix=1; prefix<m; prefix++){
+      nTrue += add((*order)[prefix-1], 1);
+      double gini_part = giniPartition(*counterTrue, *counterAll, *counterFalse, nTrue, N);
+      if(gini_part < best_loss){
+        best_loss = gini_part;
+        best_class = target;
+        best_prefix = prefix;
+      }
+    }
+  }
+  int best_single = -1;
+  if(numClasses > 2){
+    for(const int value: *present){
+      std::fill(counterTrue->begin(), counterTrue->end(), 0);
+      int nTrue = add(value, 1);
+      double gini_part = giniPartition(*counterTrue, *counterAll, *counterFalse, nTrue, N);
+      if(gini_part < best_loss){
+        best_loss = gini_part;
+        best_single = value;
+      }
+    }
+  }
+
+  if(best_single >= 0){
+    subset.push_back(best_single);
+  } else if(best_class >= 0){
+    // Rebuild the winning ordering
+    order->assign(present->begin(), present->end());
+    std::sort(order->begin(), order->end(), [&](int a, int b) {
+      const int64_t pa = int64_t(countersCat[a * numClasses + best_class]) * (*sizes)[b];
+      const int64_t pb = int64_t(countersCat[b * numClasses + best_class]) * (*sizes)[a];
+      return pa < pb || (pa == pb && a < b);
+    });
+    subset.assign(order->begin(), order->begin() + best_prefix);
+  }
+  return best_loss;
+}
+
 
 const ClassCounter Calculations::classCounts(const Data& data) {
   ClassCounter counter;
@@ -170,3 +579,235 @@ const ClassCounter Calculations::classCounts(const Data& data) {
   }
   return counter;
 }
+
+const ClassCounter Calculations::classCounts(const ColumnStore& store, RowView rows) {
+  ClassCounter counter;
+  for (const Idx r: rows) {
+    counter[store.labels()[r]]++;
+  }
+  return counter;
+}
+
+void Calculations::classTally(const ColumnStore& store, RowView rows, ClassTally& tally) {
+  for (const Idx r: rows) {
+    tally[store.labels()[r]]++;
+  }
+}
+
+namespace {
+
+struct RandomSplit {
+  double gain = 0.0;
+  int threshold = 0;
+  VecI subset = {};
+};
+
+// One random split of feature f, scored against the class counts of the node
+void randomSplit(const ColumnStore& store, RowView rows, int f, uint64_t seed, const ClassTally& tally, double gini_node, RandomSplit& split) {
+  Utils::random::SplitMix64 rng{seed};
+  const int numClasses = store.numClasses();
+  const VecI& labels = store.labels();
+  const int N = rows.size();
+  ScratchBuffer<int> counterTrue(numClasses, 0), counterFalse(numClasses, 0);
+  int nTrue = 0;
+  if(store.isNumeric(f)){
+    int lo = std::numeric_limits<int>::max(), hi = std::numeric_limits<int>::min();
+    if(store.isSparse(f)){
+      for(const Idx r: rows){
+        const int value = store.value(f, r);
+        lo = std::min(lo, value);
+        hi = std::max(hi, value);
+      }
+    } else {
+      const int* column = store.column(f).data();
+      for(const Idx r: rows){
+        lo = std::min(lo, column[r]);
+        hi = std::max(hi, column[r]);
+      }
+    }
+    if(lo == hi)
+      return;
+    // A threshold in (lo, hi] leaves rows in both branches
+    const int threshold = lo + 1 + (int) rng.below((uint64_t) ((int64_t) hi - lo));
+    if(store.isSparse(f)){
+      for(const Idx r: rows){
+        const int goesTrue = store.value(f, r) >= threshold;
+        (*counterTrue)[labels[r]] += goesTrue;
+        nTrue += goesTrue;
+      }
+    } else {
+      const int* column = store.column(f).data();
+      for(const Idx r: rows){
+        const int goesTrue = column[r] >= threshold;
+        (*counterTrue)[labels[r]] += goesTrue;
+        nTrue += goesTrue;
+      }
+    }
+    split.threshold = threshold;
+  } else {
+    const int numCategories = store.numCategories(f);
+    const VecI& column = store.column(f);
+    ScratchBuffer<int> countersCat(numCategories * numClasses, 0);
+    for(const Idx r: rows)
+      (*countersCat)[column[r] * numClasses + labels[r]]++;
+    ScratchBuffer<int> present;
+    for(int value=0; value<numCategories; value++)
+      for(int c=0; c<numClasses; c++)
+        if((*countersCat)[value * numClasses + c] > 0){
+          present->push_back(value);
+          break;
+        }
+    const int m = present->size();
+    if(m < 2)
+      return;
+    // A non-empty subset of all present categories but the first, each drawn
+    // with probability 1/2
+    split.subset.clear();
+    while(split.subset.empty())
+      for(int i=1; i<m; i++)
+        if(rng.next() & 1)
+          split.subset.push_back((*present)[i]);
+    for(const int value: split.subset)
+      for(int c=0; c<numClasses; c++){
+        (*counterTrue)[c] += (*countersCat)[value * numClasses + c];
+        nTrue += (*countersCat)[value * numClasses + c];
+      }
+  }
+  split.gain = gini_node - giniPartition(*counterTrue, tally, *counterFalse, nTrue, N);
+}
+
+}
+
+tuple<const double, const Question> Calculations::find_random_split(const ColumnStore& store, RowView rows, uint64_t seed, int maxFeatures) {
+  const int F = store.numFeatures();
+  ScratchBuffer<int> clsTally(store.numClasses(), 0);
+  classTally(store, rows, *clsTally);
+  const double gini_node = gini(*clsTally, rows.size());
+
+  // The candidates are a prefix of a random permutation of the features
+  const int K = maxFeatures > 0 ? std::min(maxFeatures, F) : F;
+  ScratchBuffer<int> features(F);
+  std::iota(features->begin(), features->end(), 0);
+  Utils::random::SplitMix64 rng{seed};
+  if(K < F)
+    for(int i=0; i<K; i++)
+      std::swap((*features)[i], (*features)[i + rng.below(F - i)]);
+
+  // Every feature draws from its own stream, so the splits do not depend on
+  // the order in which features are scanned
+  vector<RandomSplit> splits(K);
+  const auto scan = [&](size_t i) {
+    const int f = (*features)[i];
+    randomSplit(store, rows, f, Utils::random::mix(seed, f + 1), *clsTally, gini_node, splits[i]);
+  };
+  if(rows.size() >= kParallelSplitRows && K > 1){
+    NumaPools::shared().parallelFor(K, [&](size_t i) { return store.columnNode((*features)[i]); }, scan);
+  } else {
+    for(int i=0; i<K; i++)
+      scan(i);
+  }
+
+  double best_gain = 0.0;
+  int best = -1;
+  for(int i=0; i<K; i++){
+    if(splits[i].gain > best_gain){
+      best_gain = splits[i].gain;
+      best = i;
+    }
+  }
+  Question best_question;
+  if(best >= 0){
+    const int f = (*features)[best];
+    best_question = store.isNumeric(f) ? Question(f, splits[best].threshold, store.meta()) : Question(f, splits[best].subset, store.meta());
+  }
+  return forward_as_tuple(best_gain, best_question);
+}
+
+void Calculations::stratified_sample(const ColumnStore& store, RowView rows, size_t size, uint64_t seed, VecIdx& sample) {
+  const VecI& labels = store.labels();
+  const int numClasses = store.numClasses();
+  const size_t N = rows.size();
+  // Rows grouped on class by a counting sort
+  ScratchBuffer<size_t> start(numClasses + 1, 0);
+  for(const Idx r: rows)
+    (*start)[labels[r] + 1]++;
+  for(int c=0; c<numClasses; c++)
+    (*start)[c + 1] += (*start)[c];
+  ScratchBuffer<size_t> next;
+  next->assign(start->begin(), start->end() - 1);
+  ScratchBuffer<Idx> grouped(N);
+  for(const Idx r: rows)
+    (*grouped)[(*next)[labels[r]]++] = r;
+
+  Utils::random::SplitMix64 rng{seed};
+  sample.clear();
+  for(int c=0; c<numClasses; c++){
+    const size_t first = (*start)[c], count = (*start)[c + 1] - first;
+    if(count == 0)
+      continue;
+    const size_t take = std::min(count, std::max<size_t>(1, (size * count + N / 2) / N));
+    // Partial Fisher-Yates shuffle of the rows of the class
+    Idx* group = grouped->data() + first;
+    for(size_t i=0; i<take; i++){
+      std::swap(group[i], group[i + rng.below(count - i)]);
+      sample.push_back(group[i]);
+    }
+  }
+}
+
+tuple<const double, const Question> Calculations::refine_split(const ColumnStore& store, RowView rows, const Question& q) {
+  const int f = q.column_;
+  ScratchBuffer<int> clsTally(store.numClasses(), 0);
+  classTally(store, rows, *clsTally);
+  const double gini_node = gini(*clsTally, rows.size());
+  if(store.isSparse(f)){
+    // Sparse features keep the threshold found on the sample, unlike dense
+    // ones: only the gain is measured again on all rows of the node
+    const VecI& labels = store.labels();
+    ScratchBuffer<int> counterTrue(store.numClasses(), 0), counterFalse(store.numClasses(), 0);
+    int nTrue = 0;
+    if(usePresorted(rows.size(), store.numRows())){
+      // All rows start on the side of the implicit zeros; the non-zero
+      // entries of f in the node that go the other way are moved over
+      const int zeroTrue = q.matches(0);
+      if(zeroTrue){
+        std::copy(clsTally->begin(), clsTally->end(), counterTrue->begin());
+        nTrue = rows.size();
+      }
+      ScratchBuffer<int> multiplicity;
+      multiplicity->assign(store.numRows(), 0);
+      for(const Idx r: rows)
+        (*multiplicity)[r]++;
+      const VecIdx& colRows = store.sparseColumnRows();
+      const VecI& colValues = store.sparseColumnValues();
+      for(size_t i=store.sparseColumnBegin(f); i<store.sparseColumnEnd(f); i++){
+        const Idx r = colRows[i];
+        const int moved = (q.matches(colValues[i]) - zeroTrue) * (*multiplicity)[r];
+        (*counterTrue)[labels[r]] += moved;
+        nTrue += moved;
+      }
+    } else {
+      for(const Idx r: rows){
+        const int goesTrue = q.matches(store.value(f, r));
+        (*counterTrue)[labels[r]] += goesTrue;
+        nTrue += goesTrue;
+      }
+    }
+    const double gain = gini_node - giniPartition(*counterTrue, *clsTally, *counterFalse, nTrue, rows.size());
+    return forward_as_tuple(gain, q);
+  }
+  if(store.isNumeric(f)){
+    ScratchBuffer<int> multiplicity;
+    const bool presorted = usePresorted(rows.size(), store.numRows());
+    if(presorted){
+      multiplicity->assign(store.numRows(), 0);
+      for(const Idx r: rows)
+        (*multiplicity)[r]++;
+    }
+    const auto [threshold, loss] = determine_best_threshold_numeric(store, rows, f, presorted ? multiplicity->data() : nullptr);
+    return forward_as_tuple(gini_node - loss, Question(f, threshold, store.meta()));
+  }
+  VecI subset;
+  const double loss = determine_best_subset_cat(store, rows, f, subset);
+  return forward_as_tuple(gini_node - loss, Question(f, subset, store.meta()));
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <dlfcn.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "CodeGen.hpp"
+#include "Bagging.hpp"
+#include "DecisionTree.hpp"
+
+using std::string;
+using std::vector;
+
+namespace {
+
+// Runs the program args[0], looked up on the path, with args as its argument
+// vector and no shell in between; true when it exits with status 0
+bool run(const vector<string>& args) {
+  vector<char*> argv;
+  for (const string& arg: args)
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  argv.push_back(nullptr);
+  pid_t pid;
+  if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0)
+    return false;
+  int status;
+  while (waitpid(pid, &status, 0) < 0)
+    if (errno != EINTR)
+      return false;
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+string indent(int depth) {
+  return string(2 * depth + 2, ' ');
+}
+
+}
+
+CodeGen::CodeGen(const DecisionTree& tree) :
+    CodeGen({&tree.tree()}, tree.numClasses(), Predictor::Voting::Average) {}
+
+CodeGen::CodeGen(const Bagging& bagging, Predictor::Voting voting) :
+    CodeGen(bagging.trees(), bagging.learners().front().numClasses(), voting) {}
+
+CodeGen::CodeGen(const vector<const Tree*>& trees, int numClasses, Predictor::Voting voting) :
+    trees_(trees), numClasses_(numClasses), voting_(voting) {
+  // As in Predictor, trees with a probability pool give the number of classes
+  if (!trees_.empty() && !trees_.front()->probabilities().empty())
+    numClasses_ = trees_.front()->probabilities().layout().numClasses.front();
+}
+
+void CodeGen::writeTree(std::ostream& out, const Tree& tree, NodeId id, int depth, vector<std::pair<const Tree*, const Node*>>& leaves) const {
+  const Node& node = tree.node(id);
+  if (node.isLeaf()) {
+    out << indent(depth) << "return " << leaves.size() << ";\n";
+    leaves.emplace_back(&tree, &node);
+    return;
+  }
+  const Question& question = node.question();
+  const string value = "row[" + std::to_string(question.column_) + "]";
+  out << indent(depth) << "if (";
+  if (question.isNumeric()) {
+    out << value << " >= " << question.value_;
+  } else if (question.categories().size() == 1) {
+    out << "static_cast<unsigned>(" << value << ") < 64u && (UINT64_C(0x" << std::hex
+        << question.categories().front() << std::dec << ") >> " << value << ") & 1u";
+  } else {
+    out << "inSet(" << value << ", {";
+    for (size_t w = 0; w < question.categories().size(); w++)
+      out << (w ? ", " : "") << "UINT64_C(0x" << std::hex << question.categories()[w] << std::dec << ")";
+    out << "})";
+  }
+  out << ") {\n";
+  writeTree(out, tree, node.trueBranch(), depth + 1, leaves);
+  out << indent(depth) << "} else {\n";
+  writeTree(out, tree, node.falseBranch(), depth + 1, leaves);
+  out << indent(depth) << "}\n";
+}
+
+void CodeGen::write(std::ostream& out) const {
+  out << "// Generated by the DecisionTree code generator. Do not edit.\n"
+      << "#include <cstdint>\n"
+      << "#include <cstddef>\n\n"
+      << "namespace {\n\n"
+      << "constexpr int kNumClasses = " << numClasses_ << ";\n"
+      << "constexpr int kNumTrees = " << trees_.size() << ";\n\n"
+      << "template<std::size_t N>\n"
+      << "inline bool inSet(int value, const uint64_t (&words)[N]) {\n"
+      << "  const unsigned word = static_cast<unsigned>(value) >> 6;\n"
+      << "  return word < N && (words[word] >> (value & 63)) & 1u;\n"
+      << "}\n\n";
+
+  vector<std::pair<const Tree*, const Node*>> leaves;
+  for (size_t t = 0; t < trees_.size(); t++) {
+    out << "inline int tree" << t << "(const int* row) {\n";
+    writeTree(out, *trees_[t], trees_[t]->root(), 0, leaves);
+    out << "}\n\n";
+  }
+
+  // Leaf tables: class probabilities, as the trees computed them, and most
+  // likely class
+  out << std::setprecision(17);
+  out << "constexpr double kLeafProbabilities[][kNumClasses] = {\n";
+  vector<int> labels;
+  vector<double> probabilities(numClasses_);
+  for (const auto& [tree, leaf]: leaves) {
+    tree->leafProbabilities(*leaf, numClasses_, probabilities.data());
+    labels.push_back(std::max_element(probabilities.begin(), probabilities.end()) - probabilities.begin());
+    out << "  {";
+    for (int c = 0; c < numClasses_; c++)
+      out << (c ? ", " : "") << probabilities[c];
+    out << "},\n";
+  }
+  out << "};\n\n";
+  out << "constexpr int kLeafLabels[] = {";
+  for (size_t l = 0; l < labels.size(); l++)
+    out << (l ? ", " : "") << labels[l];
+  out << "};\n\n";
+
+  out << "inline void vote(int leaf, double* probabilities) {\n";
+  if (voting_ == Predictor::Voting::Majority) {
+    out << "  probabilities[kLeafLabels[leaf]] += 1.0;\n";
+  } else {
+    out << "  for (int c = 0; c < kNumClasses; c++)\n"
+        << "    probabilities[c] += kLeafProbabilities[leaf][c];\n";
+  }
+  out << "}\n\n"
+      << "} // namespace\n\n"
+      << "extern \"C\" {\n\n"
+      << "int cart_num_classes() { return kNumClasses; }\n\n"
+      << "void cart_predict_proba(const int* row, double* probabilities) {\n"
+      << "  for (int c = 0; c < kNumClasses; c++)\n"
+      << "    probabilities[c] = 0.0;\n";
+  for (size_t t = 0; t < trees_.size(); t++)
+    out << "  vote(tree" << t << "(row), probabilities);\n";
+  out << "  for (int c = 0; c < kNumClasses; c++)\n"
+      << "    probabilities[c] /= kNumTrees;\n"
+      << "}\n\n"
+      << "int cart_predict(const int* row) {\n";
+  if (trees_.size() == 1) {
+    out << "  return kLeafLabels[tree0(row)];\n";
+  } else {
+    out << "  double probabilities[kNumClasses];\n"
+        << "  cart_predict_proba(row, probabilities);\n"
+        << "  int best = 0;\n"
+        << "  for (int c = 1; c < kNumClasses; c++)\n"
+        << "    if (probabilities[c] > probabilities[best])\n"
+        << "      best = c;\n"
+        << "  return best;\n";
+  }
+  out << "}\n\n"
+      << "} // extern \"C\"\n";
+}
+
+void CodeGen::write(const string& filename) const {
+  std::ofstream file(filename);
+  if (!file)
+    throw std::runtime_error("Can't open file: " + filename);
+  write(file);
+}
+
+CompiledModel::CompiledModel(const string& sharedObject) :
+    handle_(dlopen(sharedObject.c_str(), RTLD_NOW | RTLD_LOCAL)),
+    numClasses_(nullptr),
+    predict_(nullptr),
+    predictProba_(nullptr) {
+  if (!handle_)
+    throw std::runtime_error("Can't load model: " + string(dlerror()));
+  numClasses_ = reinterpret_cast<int (*)()>(dlsym(handle_, "cart_num_classes"));
+  predict_ = reinterpret_cast<int (*)(const int*)>(dlsym(handle_, "cart_predict"));
+  predictProba_ = reinterpret_cast<void (*)(const int*, double*)>(dlsym(handle_, "cart_predict_proba"));
+  if (!numClasses_ || !predict_ || !predictProba_) {
+    dlclose(handle_);
+    throw std::runtime_error("Not a generated model: " + sharedObject);
+  }
+}
+
+CompiledModel::CompiledModel(CompiledModel&& other) noexcept :
+    handle_(other.handle_),
+    numClasses_(other.numClasses_),
+    predict_(other.predict_),
+    predictProba_(other.predictProba_) {
+  other.handle_ = nullptr;
+}
+
+CompiledModel::~CompiledModel() {
+  if (handle_)
+    dlclose(handle_);
+}
+
+CompiledModel CompiledModel::compile(const CodeGen& model, const string& basename) {
+  const string source = basename + ".cpp";
+  const string sharedObject = basename + ".so";
+  model.write(source);
+  const char* cxx = std::getenv("CXX");
+  const vector<string> command = {cxx ? cxx : "c++", "-std=c++17", "-O2", "-shared", "-fPIC", "-o", sharedObject, source};
+  if (!run(command))
+    throw std::runtime_error("Can't compile model: " + source);
+  // dlopen only searches the library path for names without a slash
+  return CompiledModel(sharedObject.find('/') == string::npos ? "./" + sharedObject : sharedObject);
+}
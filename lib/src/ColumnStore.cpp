@@ -0,0 +1,410 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <climits>
+#include <stdexcept>
+#include <tuple>
+#include <unordered_map>
+#include "ColumnStore.hpp"
+#include "Numa.hpp"
+
+namespace {
+
+// Attributes non-zero in more than this fraction of the rows are not bundled
+constexpr double kMaxBundleDensity = 0.5;
+
+}
+
+ColumnStore::ColumnStore(const Data& data, const MetaData& meta) :
+    meta_(meta),
+    columns_(meta.labels.size() - 1),
+    labels_(data.size()),
+    numeric_(),
+    sparse_(),
+    numCategories_(),
+    sorted_(),
+    csr_(),
+    csc_(),
+    sketches_(),
+    sketchValues_(),
+    sketchBins_(),
+    numClasses_(0),
+    outputs_(),
+    numNodes_(NumaPools::shared().numNodes()),
+    features_(),
+    redundant_(),
+    bundles_() {
+  const size_t F = columns_.size();
+  for (size_t r = 0; r < data.size(); r++) {
+    labels_[r] = data[r][F];
+    numClasses_ = std::max(numClasses_, labels_[r] + 1);
+  }
+  // Every column is first written by a worker of its own node
+  NumaPools::shared().parallelFor(F, [this](size_t f) { return columnNode(f); }, [&](size_t f) {
+    VecI column(data.size());
+    for (size_t r = 0; r < data.size(); r++)
+      column[r] = data[r][f];
+    columns_[f] = std::move(column);
+  });
+  sparse_.assign(F, false);
+  index(true);
+}
+
+ColumnStore::ColumnStore(const MetaData& meta, std::vector<VecI> columns) :
+    meta_(meta),
+    columns_(std::move(columns)),
+    labels_(),
+    numeric_(),
+    sparse_(),
+    numCategories_(),
+    sorted_(),
+    csr_(),
+    csc_(),
+    sketches_(),
+    sketchValues_(),
+    sketchBins_(),
+    numClasses_(0),
+    outputs_(),
+    numNodes_(NumaPools::shared().numNodes()),
+    features_(),
+    redundant_(),
+    bundles_() {
+  if (columns_.size() != meta.labels.size())
+    throw std::runtime_error("Number of columns does not match the meta data.");
+  labels_ = std::move(columns_.back());
+  columns_.pop_back();
+  for (const int label: labels_)
+    numClasses_ = std::max(numClasses_, label + 1);
+  sparse_.assign(columns_.size(), false);
+  index(false);
+}
+
+ColumnStore::ColumnStore(const MetaData& meta, SparseMatrix matrix, VecI labels) :
+    meta_(meta),
+    columns_(meta.labels.size() - 1),
+    labels_(std::move(labels)),
+    numeric_(),
+    sparse_(),
+    numCategories_(),
+    sorted_(),
+    csr_(std::move(matrix)),
+    csc_(),
+    sketches_(),
+    sketchValues_(),
+    sketchBins_(),
+    numClasses_(0),
+    outputs_(),
+    numNodes_(1),
+    features_(),
+    redundant_(),
+    bundles_() {
+  const size_t F = columns_.size();
+  if (csr_.numRows() != labels_.size())
+    throw std::runtime_error("Number of sparse rows does not match the number of labels.");
+  for (const int label: labels_)
+    numClasses_ = std::max(numClasses_, label + 1);
+  sparse_.assign(F, true);
+
+  // Counting sort of the entries on feature gives the CSC layout, after
+  // which every column is sorted on value
+  csc_.colStart.assign(F + 1, 0);
+  for (const Idx f: csr_.feature) {
+    if (f >= F)
+      throw std::runtime_error("Sparse feature index out of range: " + std::to_string(f));
+    csc_.colStart[f + 1]++;
+  }
+  for (size_t f = 0; f < F; f++)
+    csc_.colStart[f + 1] += csc_.colStart[f];
+  csc_.row.resize(csr_.nonZeros());
+  csc_.value.resize(csr_.nonZeros());
+  std::vector<size_t> next(csc_.colStart.begin(), csc_.colStart.end() - 1);
+  for (size_t r = 0; r < csr_.numRows(); r++) {
+    for (size_t i = csr_.rowStart[r]; i < csr_.rowStart[r + 1]; i++) {
+      const size_t slot = next[csr_.feature[i]]++;
+      csc_.row[slot] = r;
+      csc_.value[slot] = csr_.value[i];
+    }
+  }
+  std::vector<std::pair<int, Idx>> entries;
+  for (size_t f = 0; f < F; f++) {
+    const size_t begin = csc_.colStart[f], end = csc_.colStart[f + 1];
+    entries.clear();
+    for (size_t i = begin; i < end; i++)
+      entries.emplace_back(csc_.value[i], csc_.row[i]);
+    std::stable_sort(entries.begin(), entries.end(), [](const auto& a, const auto& b) {
+      return a.first < b.first;
+    });
+    for (size_t i = begin; i < end; i++)
+      std::tie(csc_.value[i], csc_.row[i]) = entries[i - begin];
+  }
+  index(true);
+}
+
+ColumnStore::ColumnStore(const MetaData& meta, std::vector<VecI> columns, size_t numOutputs) :
+    meta_(meta),
+    columns_(std::move(columns)),
+    labels_(),
+    numeric_(),
+    sparse_(),
+    numCategories_(),
+    sorted_(),
+    csr_(),
+    csc_(),
+    sketches_(),
+    sketchValues_(),
+    sketchBins_(),
+    numClasses_(0),
+    outputs_(),
+    numNodes_(NumaPools::shared().numNodes()),
+    features_(),
+    redundant_(),
+    bundles_() {
+  if (columns_.size() != meta.labels.size() || numOutputs < 1 || numOutputs >= columns_.size())
+    throw std::runtime_error("Number of columns does not match the meta data.");
+  const size_t F = columns_.size() - numOutputs;
+  const size_t n = columns_.front().size();
+  outputs_.numClasses.assign(numOutputs, 0);
+  for (size_t o = 0; o < numOutputs; o++) {
+    const std::string& label = meta.labels[F + o];
+    if (meta.dMapIS.count(label))
+      outputs_.numClasses[o] = meta.dMapIS.at(label).size();
+  }
+
+  if (numOutputs == 1) {
+    labels_ = std::move(columns_.back());
+    for (const int label: labels_)
+      numClasses_ = std::max(numClasses_, label + 1);
+    outputs_.numClasses[0] = std::max(outputs_.numClasses[0], numClasses_);
+  } else {
+    // Joint classes are numbered in order of first appearance
+    std::map<VecI, int> joint;
+    VecI key(numOutputs);
+    labels_.resize(n);
+    for (size_t r = 0; r < n; r++) {
+      for (size_t o = 0; o < numOutputs; o++) {
+        key[o] = columns_[F + o][r];
+        outputs_.numClasses[o] = std::max(outputs_.numClasses[o], key[o] + 1);
+      }
+      const auto [found, added] = joint.emplace(key, joint.size());
+      if (added)
+        outputs_.outputClass.insert(outputs_.outputClass.end(), key.begin(), key.end());
+      labels_[r] = found->second;
+    }
+    numClasses_ = joint.size();
+  }
+  columns_.resize(F);
+  sparse_.assign(F, false);
+  index(false);
+}
+
+void ColumnStore::index(bool placed) {
+  if (outputs_.numClasses.empty())
+    outputs_ = OutputLayout::single(numClasses_);
+  const size_t F = columns_.size();
+  numeric_.resize(F);
+  numCategories_.assign(F, 0);
+  sorted_.resize(F);
+  features_.resize(F);
+  std::iota(features_.begin(), features_.end(), 0);
+  redundant_.assign(F, false);
+  bundles_.clear();
+  for (size_t f = 0; f < F; f++) {
+    if (meta_.types[f] == "NUMERIC") {
+      numeric_[f] = true;
+    } else if (meta_.types[f] == "CATEGORICAL") {
+      if (sparse_[f])
+        throw std::runtime_error("Sparse attributes must be numeric.");
+      numeric_[f] = false;
+      numCategories_[f] = meta_.dMapIS.count(meta_.labels[f]) ? meta_.dMapIS.at(meta_.labels[f]).size() : 0;
+      for (const int value: columns_[f])
+        numCategories_[f] = std::max(numCategories_[f], value + 1);
+    } else {
+      throw std::runtime_error("Attribute type is neither NUMERICAL nor CATEGORICAL.");
+    }
+  }
+
+  NumaPools::shared().parallelFor(F, [this](size_t f) { return columnNode(f); }, [&](size_t f) {
+    if (sparse_[f])
+      return;
+    // Columns read on another thread are copied to move them to their node
+    if (!placed && numNodes_ > 1)
+      columns_[f] = VecI(columns_[f]);
+    if (!numeric_[f])
+      return;
+    VecIdx sorted(labels_.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    const VecI& values = columns_[f];
+    std::stable_sort(sorted.begin(), sorted.end(), [&values](Idx a, Idx b) {
+      return values[a] < values[b];
+    });
+    sorted_[f] = std::move(sorted);
+  });
+}
+
+void ColumnStore::buildSketches(double epsilon) {
+  // Keeps the number of bins within 16 bits
+  if (epsilon < 1e-4)
+    throw std::runtime_error("Sketch error must be at least 1e-4.");
+  const size_t F = columns_.size();
+  const size_t n = labels_.size();
+  // Up to 64 parts per column, merged in a balanced tree of six levels
+  const size_t parts = std::min<size_t>(64, std::max<size_t>(1, n >> 16));
+  std::vector<QuantileSketch> partial(F * parts, QuantileSketch(epsilon));
+  NumaPools::shared().parallelFor(F * parts, [this, parts](size_t t) { return columnNode(t / parts); }, [&](size_t t) {
+    const size_t f = t / parts, p = t % parts;
+    if (sparse_[f] || !numeric_[f])
+      return;
+    const int* values = columns_[f].data();
+    partial[t] = QuantileSketch(values + n * p / parts, values + n * (p + 1) / parts, epsilon);
+  });
+
+  sketches_.assign(F, QuantileSketch(epsilon));
+  sketchValues_.assign(F, {});
+  sketchBins_.assign(F, {});
+  NumaPools::shared().parallelFor(F, [this](size_t f) { return columnNode(f); }, [&](size_t f) {
+    if (sparse_[f] || !numeric_[f])
+      return;
+    QuantileSketch* part = &partial[f * parts];
+    for (size_t step = 1; step < parts; step *= 2)
+      for (size_t p = 0; p + step < parts; p += 2 * step)
+        part[p].merge(part[p + step]);
+    sketches_[f] = std::move(part[0]);
+    const VecI values = sketches_[f].values();
+    std::vector<uint16_t> bins(n);
+    for (size_t r = 0; r < n; r++)
+      bins[r] = std::upper_bound(values.begin(), values.end(), columns_[f][r]) - values.begin();
+    sketchValues_[f] = values;
+    sketchBins_[f] = std::move(bins);
+  });
+}
+
+void ColumnStore::reduceFeatures() {
+  const size_t F = columns_.size();
+  const size_t n = labels_.size();
+  redundant_.assign(F, false);
+  bundles_.clear();
+
+  // Constant columns; the others are hashed to find the duplicates
+  std::vector<uint64_t> hashes(F, 0);
+  std::vector<bool> constant(F, false);
+  NumaPools::shared().parallelFor(F, [this](size_t f) { return columnNode(f); }, [&](size_t f) {
+    if (sparse_[f]) {
+      constant[f] = csc_.colStart[f] == csc_.colStart[f + 1];
+      return;
+    }
+    const VecI& values = columns_[f];
+    constant[f] = std::all_of(values.begin(), values.end(), [&values](int v) { return v == values.front(); });
+    uint64_t hash = numeric_[f] ? 0 : numCategories_[f] + 1;
+    for (const int v: values)
+      hash = Utils::random::mix(hash, (uint32_t) v);
+    hashes[f] = hash;
+  });
+  // An attribute equal to an earlier one never splits better than it
+  std::unordered_map<uint64_t, VecI> kept;
+  for (size_t f = 0; f < F; f++) {
+    if (constant[f]) {
+      redundant_[f] = true;
+      continue;
+    }
+    if (sparse_[f])
+      continue;
+    VecI& same = kept[hashes[f]];
+    redundant_[f] = std::any_of(same.begin(), same.end(), [&](int g) {
+      return numeric_[g] == numeric_[f] && numCategories_[g] == numCategories_[f] && columns_[g] == columns_[f];
+    });
+    if (!redundant_[f])
+      same.push_back(f);
+  }
+
+  // Bundling candidates, the densest first
+  std::vector<std::pair<size_t, int>> candidates;
+  for (size_t f = 0; f < F; f++) {
+    if (redundant_[f] || sparse_[f] || !numeric_[f])
+      continue;
+    const VecI& values = columns_[f];
+    if (std::any_of(values.begin(), values.end(), [](int v) { return v < 0; }))
+      continue;
+    const size_t nonZeros = n - std::count(values.begin(), values.end(), 0);
+    if (nonZeros <= kMaxBundleDensity * n)
+      candidates.emplace_back(nonZeros, f);
+  }
+  std::stable_sort(candidates.begin(), candidates.end(), [](const auto& a, const auto& b) {
+    return a.first > b.first;
+  });
+
+  // Every candidate joins the first bundle none of whose rows it conflicts
+  // with; the rows a bundle occupies are the non-zeros of its column
+  std::vector<FeatureBundle> bundles;
+  VecIdx nonZero;
+  for (const auto& [nonZeros, f]: candidates) {
+    const VecI& values = columns_[f];
+    nonZero.clear();
+    for (size_t r = 0; r < n; r++)
+      if (values[r] != 0)
+        nonZero.push_back(r);
+    const int top = *std::max_element(values.begin(), values.end());
+    FeatureBundle* target = nullptr;
+    for (FeatureBundle& bundle: bundles) {
+      if (bundle.offsets.back() > INT_MAX - top)
+        continue;
+      if (std::none_of(nonZero.begin(), nonZero.end(), [&bundle](Idx r) { return bundle.column[r] != 0; })) {
+        target = &bundle;
+        break;
+      }
+    }
+    if (target == nullptr) {
+      bundles.emplace_back();
+      target = &bundles.back();
+      target->offsets.push_back(0);
+      target->column.assign(n, 0);
+    }
+    for (const Idx r: nonZero)
+      target->column[r] = target->offsets.back() + values[r];
+    target->members.push_back(f);
+    target->offsets.push_back(target->offsets.back() + top);
+  }
+
+  // Bundles of one attribute are dissolved; the others are laid out again
+  // with their members in ascending order
+  std::vector<bool> bundled(F, false);
+  for (FeatureBundle& bundle: bundles) {
+    if (bundle.members.size() < 2)
+      continue;
+    std::sort(bundle.members.begin(), bundle.members.end());
+    bundle.offsets.assign(1, 0);
+    std::fill(bundle.column.begin(), bundle.column.end(), 0);
+    for (const int f: bundle.members) {
+      const VecI& values = columns_[f];
+      for (size_t r = 0; r < n; r++)
+        if (values[r] != 0)
+          bundle.column[r] = bundle.offsets.back() + values[r];
+      bundle.offsets.push_back(bundle.offsets.back() + *std::max_element(values.begin(), values.end()));
+      bundled[f] = true;
+    }
+    for (size_t r = 0; r < n; r++)
+      if (bundle.column[r] != 0)
+        bundle.nonZeroRows.push_back(r);
+    const VecI& column = bundle.column;
+    std::stable_sort(bundle.nonZeroRows.begin(), bundle.nonZeroRows.end(), [&column](Idx a, Idx b) {
+      return column[a] < column[b];
+    });
+    bundles_.push_back(std::move(bundle));
+  }
+
+  features_.clear();
+  for (size_t f = 0; f < F; f++)
+    if (!redundant_[f] && !bundled[f])
+      features_.push_back(f);
+}
+
+int ColumnStore::value(int f, Idx r) const {
+  if (!sparse_[f])
+    return columns_[f][r];
+  const auto first = csr_.feature.begin() + csr_.rowStart[r];
+  const auto last = csr_.feature.begin() + csr_.rowStart[r + 1];
+  const auto found = std::lower_bound(first, last, Idx(f));
+  return found != last && *found == Idx(f) ? csr_.value[found - csr_.feature.begin()] : 0;
+}
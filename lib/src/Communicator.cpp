@@ -0,0 +1,235 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+#include "Communicator.hpp"
+
+namespace {
+
+struct Endpoint {
+  bool local = true; // Unix domain socket, else TCP
+  std::string path = {};
+  std::string host = {};
+  int port = 0;
+};
+
+Endpoint endpointOf(const std::string& address, int rank) {
+  Endpoint endpoint;
+  if (address.compare(0, 5, "unix:") == 0) {
+    endpoint.path = address.substr(5) + "." + std::to_string(rank);
+    return endpoint;
+  }
+  const size_t colon = address.rfind(':');
+  if (address.compare(0, 4, "tcp:") != 0 || colon <= 4)
+    throw std::runtime_error("Invalid address, expected unix:<prefix> or tcp:<host>:<port>: " + address);
+  endpoint.local = false;
+  endpoint.host = address.substr(4, colon - 4);
+  endpoint.port = std::stoi(address.substr(colon + 1)) + rank;
+  return endpoint;
+}
+
+[[noreturn]] void fail(const std::string& what) {
+  throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+
+// Sockets take a generic address; both kinds are filled in here
+socklen_t fillAddress(const Endpoint& endpoint, sockaddr_storage& storage) {
+  std::memset(&storage, 0, sizeof(storage));
+  if (endpoint.local) {
+    sockaddr_un& address = reinterpret_cast<sockaddr_un&>(storage);
+    if (endpoint.path.size() >= sizeof(address.sun_path))
+      throw std::runtime_error("Socket path too long: " + endpoint.path);
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, endpoint.path.c_str());
+    return sizeof(sockaddr_un);
+  }
+  addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo* found = nullptr;
+  if (getaddrinfo(endpoint.host.c_str(), nullptr, &hints, &found) != 0 || found == nullptr)
+    throw std::runtime_error("Unknown host: " + endpoint.host);
+  sockaddr_in& address = reinterpret_cast<sockaddr_in&>(storage);
+  address = *reinterpret_cast<sockaddr_in*>(found->ai_addr);
+  address.sin_port = htons(endpoint.port);
+  freeaddrinfo(found);
+  return sizeof(sockaddr_in);
+}
+
+int openSocket(const Endpoint& endpoint) {
+  const int fd = socket(endpoint.local ? AF_UNIX : AF_INET, SOCK_STREAM, 0);
+  if (fd < 0)
+    fail("Can't create socket");
+  if (!endpoint.local) {
+    const int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    // Histograms are sent in one piece per step, waiting on Nagle only adds latency
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+  }
+  return fd;
+}
+
+int listenOn(const Endpoint& endpoint) {
+  const int fd = openSocket(endpoint);
+  sockaddr_storage address;
+  const socklen_t length = fillAddress(endpoint, address);
+  if (endpoint.local)
+    unlink(endpoint.path.c_str());
+  if (bind(fd, reinterpret_cast<sockaddr*>(&address), length) != 0 || listen(fd, 1) != 0) {
+    close(fd);
+    fail("Can't listen on " + (endpoint.local ? endpoint.path : endpoint.host + ":" + std::to_string(endpoint.port)));
+  }
+  return fd;
+}
+
+int connectTo(const Endpoint& endpoint, int timeoutSeconds) {
+  sockaddr_storage address;
+  const socklen_t length = fillAddress(endpoint, address);
+  const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(timeoutSeconds);
+  while (true) {
+    const int fd = openSocket(endpoint);
+    if (connect(fd, reinterpret_cast<sockaddr*>(&address), length) == 0)
+      return fd;
+    close(fd);
+    if (std::chrono::steady_clock::now() > deadline)
+      fail("Can't connect to " + (endpoint.local ? endpoint.path : endpoint.host + ":" + std::to_string(endpoint.port)));
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+void writeAll(int fd, const void* data, size_t bytes) {
+  const char* p = static_cast<const char*>(data);
+  while (bytes > 0) {
+    const ssize_t sent = send(fd, p, bytes, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR)
+      continue;
+    if (sent <= 0)
+      fail("Can't send to peer");
+    p += sent;
+    bytes -= sent;
+  }
+}
+
+void readAll(int fd, void* data, size_t bytes) {
+  char* p = static_cast<char*>(data);
+  while (bytes > 0) {
+    const ssize_t received = recv(fd, p, bytes, 0);
+    if (received < 0 && errno == EINTR)
+      continue;
+    if (received <= 0)
+      fail("Can't receive from peer");
+    p += received;
+    bytes -= received;
+  }
+}
+
+}
+
+Communicator::Communicator() :
+    rank_(0), size_(1), next_(-1), prev_(-1), listenPath_() {
+}
+
+Communicator::Communicator(int rank, int size, const std::string& address, int timeoutSeconds) :
+    rank_(rank), size_(size), next_(-1), prev_(-1), listenPath_() {
+  if (size < 1 || rank < 0 || rank >= size)
+    throw std::runtime_error("Invalid rank " + std::to_string(rank) + " of " + std::to_string(size) + " workers");
+  if (size == 1)
+    return;
+
+  // Listen before connecting, so that the connections of all ranks are
+  // queued by the kernel however the processes are scheduled
+  const Endpoint self = endpointOf(address, rank);
+  const int listener = listenOn(self);
+  if (self.local)
+    listenPath_ = self.path;
+  try {
+    next_ = connectTo(endpointOf(address, (rank + 1) % size), timeoutSeconds);
+    writeAll(next_, &rank_, sizeof(rank_));
+    prev_ = accept(listener, nullptr, nullptr);
+    if (prev_ < 0)
+      fail("Can't accept connection");
+    int peer = -1;
+    readAll(prev_, &peer, sizeof(peer));
+    if (peer != (rank + size - 1) % size)
+      throw std::runtime_error("Expected rank " + std::to_string((rank + size - 1) % size)
+          + " to connect, got " + std::to_string(peer));
+  } catch (...) {
+    close(listener);
+    disconnect();
+    throw;
+  }
+  close(listener);
+  fcntl(next_, F_SETFL, fcntl(next_, F_GETFL) | O_NONBLOCK);
+  fcntl(prev_, F_SETFL, fcntl(prev_, F_GETFL) | O_NONBLOCK);
+}
+
+Communicator::~Communicator() {
+  disconnect();
+}
+
+void Communicator::disconnect() {
+  if (next_ >= 0)
+    close(next_);
+  if (prev_ >= 0)
+    close(prev_);
+  if (!listenPath_.empty())
+    unlink(listenPath_.c_str());
+  next_ = prev_ = -1;
+  listenPath_.clear();
+}
+
+void Communicator::exchange(const void* send, size_t sendBytes, void* recv, size_t recvBytes) {
+  const char* out = static_cast<const char*>(send);
+  char* in = static_cast<char*>(recv);
+  while (sendBytes > 0 || recvBytes > 0) {
+    pollfd fds[2];
+    nfds_t count = 0;
+    if (sendBytes > 0)
+      fds[count++] = {next_, POLLOUT, 0};
+    if (recvBytes > 0)
+      fds[count++] = {prev_, POLLIN, 0};
+    if (poll(fds, count, -1) < 0) {
+      if (errno == EINTR)
+        continue;
+      fail("Can't poll peers");
+    }
+    for (nfds_t i = 0; i < count; i++) {
+      if (fds[i].revents == 0)
+        continue;
+      if (fds[i].fd == next_) {
+        const ssize_t sent = ::send(next_, out, sendBytes, MSG_NOSIGNAL);
+        if (sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+          continue;
+        if (sent <= 0)
+          fail("Can't send to rank " + std::to_string((rank_ + 1) % size_));
+        out += sent;
+        sendBytes -= sent;
+      } else {
+        const ssize_t received = ::recv(prev_, in, recvBytes, 0);
+        if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR))
+          continue;
+        if (received <= 0)
+          fail("Can't receive from rank " + std::to_string((rank_ + size_ - 1) % size_));
+        in += received;
+        recvBytes -= received;
+      }
+    }
+  }
+}
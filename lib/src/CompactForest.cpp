@@ -0,0 +1,246 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cmath>
+#include <deque>
+#include "CompactForest.hpp"
+#include "Arena.hpp"
+#include "Bagging.hpp"
+#include "DecisionTree.hpp"
+
+using std::vector;
+
+namespace {
+
+template<typename F>
+void forEachQuestion(const Tree& tree, F&& visit) {
+  for (NodeId id = 0; id < tree.nodeCount(); id++)
+    if (!tree.node(id).isLeaf())
+      visit(tree.node(id).question());
+}
+
+}
+
+CompactForest::CompactForest(const DecisionTree& tree, int probabilityBits) :
+    CompactForest({&tree.tree()}, tree.numClasses(), Predictor::Voting::Average, probabilityBits) {}
+
+CompactForest::CompactForest(const Bagging& bagging, Predictor::Voting voting, int probabilityBits) :
+    CompactForest(bagging.trees(), bagging.learners().front().numClasses(), voting, probabilityBits) {}
+
+CompactForest::CompactForest(const vector<const Tree*>& trees, int numClasses, Predictor::Voting voting, int probabilityBits) :
+    numClasses_(numClasses),
+    voting_(voting),
+    probabilityBits_(probabilityBits),
+    nodes_(),
+    roots_(),
+    numColumns_(0),
+    categoricalColumns_(),
+    edges_(),
+    categorySets_(),
+    categoryWords_(),
+    probabilities_(),
+    labels_() {
+  if (probabilityBits_ != 8 && probabilityBits_ != 16)
+    throw std::runtime_error("Probabilities are stored with either 8 or 16 bits.");
+  // As in Predictor, trees with a probability pool give the number of classes
+  if (!trees.empty() && !trees.front()->probabilities().empty())
+    numClasses_ = trees.front()->probabilities().layout().numClasses.front();
+
+  // Bin edges: every threshold the forest uses on a column
+  for (const Tree* tree: trees)
+    forEachQuestion(*tree, [&](const Question& q) {
+      numColumns_ = std::max<size_t>(numColumns_, q.column_ + 1);
+    });
+  if (numColumns_ >= kCategorical)
+    throw std::runtime_error("Too many columns for a compact forest.");
+  categoricalColumns_.assign(numColumns_, 0);
+  edges_.resize(numColumns_);
+  for (const Tree* tree: trees)
+    forEachQuestion(*tree, [&](const Question& q) {
+      if (q.isNumeric())
+        edges_[q.column_].push_back(q.value_);
+      else
+        categoricalColumns_[q.column_] = 1;
+    });
+  for (auto& edges: edges_) {
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+    if (edges.size() >= kLeaf)
+      throw std::runtime_error("Too many thresholds on a column for a compact forest.");
+  }
+
+  std::map<vector<uint64_t>, uint16_t> sets;
+  std::map<std::pair<vector<uint16_t>, int>, uint32_t> distributions;
+  for (const Tree* tree: trees)
+    layout(*tree, sets, distributions);
+  nodes_.shrink_to_fit();
+}
+
+void CompactForest::layout(const Tree& tree, std::map<vector<uint64_t>, uint16_t>& sets, std::map<std::pair<vector<uint16_t>, int>, uint32_t>& distributions) {
+  const double scale = (1 << probabilityBits_) - 1;
+  vector<double> exact(numClasses_);
+  roots_.push_back(nodes_.size());
+  nodes_.push_back({kLeaf, 0, 0});
+  // Breadth-first: the children of a node are appended as a pair when the
+  // node is visited
+  std::deque<std::pair<NodeId, uint32_t>> queue = {{tree.root(), roots_.back()}};
+  while (!queue.empty()) {
+    const auto [id, slot] = queue.front();
+    queue.pop_front();
+    const Node& node = tree.node(id);
+    if (node.isLeaf()) {
+      tree.leafProbabilities(node, numClasses_, exact.data());
+      vector<uint16_t> distribution(numClasses_, 0);
+      for (size_t c = 0; c < numClasses_; c++)
+        distribution[c] = std::lround(exact[c] * scale);
+      // The label comes from the exact probabilities and is part of the key:
+      // leaves that round to the same distribution can still disagree on it
+      const int label = std::max_element(exact.begin(), exact.end()) - exact.begin();
+      const auto [it, added] = distributions.emplace(std::make_pair(distribution, label), labels_.size());
+      if (added) {
+        for (const uint16_t p: distribution) {
+          probabilities_.push_back(p & 0xFF);
+          if (probabilityBits_ == 16)
+            probabilities_.push_back(p >> 8);
+        }
+        labels_.push_back(label);
+      }
+      nodes_[slot] = {kLeaf, 0, it->second};
+      continue;
+    }
+    const Question& q = node.question();
+    CompactNode compact = {static_cast<uint16_t>(q.column_), 0, static_cast<uint32_t>(nodes_.size())};
+    if (q.isNumeric()) {
+      const auto& edges = edges_[q.column_];
+      compact.split = std::lower_bound(edges.begin(), edges.end(), q.value_) - edges.begin() + 1;
+    } else {
+      const auto [it, added] = sets.emplace(q.categories(), categorySets_.size() / 2);
+      if (added) {
+        if (it->second >= kLeaf)
+          throw std::runtime_error("Too many category sets for a compact forest.");
+        categorySets_.push_back(categoryWords_.size());
+        categorySets_.push_back(q.categories().size());
+        categoryWords_.insert(categoryWords_.end(), q.categories().begin(), q.categories().end());
+      }
+      compact.column |= kCategorical;
+      compact.split = it->second;
+    }
+    nodes_[slot] = compact;
+    nodes_.push_back({kLeaf, 0, 0});
+    nodes_.push_back({kLeaf, 0, 0});
+    queue.emplace_back(node.trueBranch(), compact.child);
+    queue.emplace_back(node.falseBranch(), compact.child + 1);
+  }
+}
+
+void CompactForest::quantize(const VecI& row, uint16_t* bins) const {
+  for (size_t c = 0; c < numColumns_; c++) {
+    const int value = row[c];
+    if (categoricalColumns_[c])
+      bins[c] = value >= 0 && value < kLeaf ? value : kLeaf;
+    else
+      bins[c] = std::upper_bound(edges_[c].begin(), edges_[c].end(), value) - edges_[c].begin();
+  }
+}
+
+inline uint32_t CompactForest::leafOf(uint32_t root, const uint16_t* bins) const {
+  const CompactNode* node = &nodes_[root];
+  while (node->column != kLeaf) {
+    bool goTrue;
+    if (node->column & kCategorical) {
+      const uint16_t value = bins[node->column & ~kCategorical];
+      const uint32_t word = value >> 6;
+      goTrue = word < categorySets_[2 * node->split + 1]
+        && (categoryWords_[categorySets_[2 * node->split] + word] >> (value & 63)) & 1;
+    } else {
+      goTrue = bins[node->column] >= node->split;
+    }
+    node = &nodes_[node->child + !goTrue];
+  }
+  return node->child;
+}
+
+inline void CompactForest::vote(uint32_t distribution, double* out) const {
+  if (voting_ == Predictor::Voting::Majority) {
+    out[labels_[distribution]] += 1.0;
+  } else if (probabilityBits_ == 8) {
+    const uint8_t* p = probabilities_.data() + distribution * numClasses_;
+    for (size_t c = 0; c < numClasses_; c++)
+      out[c] += p[c] / 255.0;
+  } else {
+    const uint8_t* p = probabilities_.data() + 2 * distribution * numClasses_;
+    for (size_t c = 0; c < numClasses_; c++)
+      out[c] += (p[2 * c] | (p[2 * c + 1] << 8)) / 65535.0;
+  }
+}
+
+void CompactForest::score(const Data& rows, size_t rowBegin, size_t rowEnd, double* out) const {
+  ScratchBuffer<uint16_t> bins((rowEnd - rowBegin) * numColumns_);
+  for (size_t r = rowBegin; r < rowEnd; r++)
+    quantize(rows[r], bins->data() + (r - rowBegin) * numColumns_);
+  for (const uint32_t root: roots_)
+    for (size_t r = 0; r < rowEnd - rowBegin; r++)
+      vote(leafOf(root, bins->data() + r * numColumns_), out + r * numClasses_);
+}
+
+void CompactForest::predictProba(const VecI& row, double* probabilities) const {
+  std::fill(probabilities, probabilities + numClasses_, 0.0);
+  ScratchBuffer<uint16_t> bins(numColumns_);
+  quantize(row, bins->data());
+  for (const uint32_t root: roots_)
+    vote(leafOf(root, bins->data()), probabilities);
+  for (size_t c = 0; c < numClasses_; c++)
+    probabilities[c] /= roots_.size();
+}
+
+int CompactForest::predict(const VecI& row) const {
+  ScratchBuffer<double> probabilities(numClasses_);
+  predictProba(row, probabilities->data());
+  return std::max_element(probabilities->begin(), probabilities->end()) - probabilities->begin();
+}
+
+Predictions CompactForest::predict(const Data& rows) const {
+  return predict(rows, ThreadPool::shared());
+}
+
+Predictions CompactForest::predict(const Data& rows, ThreadPool& pool) const {
+  const size_t N = rows.size(), C = numClasses_;
+  Predictions predictions;
+  predictions.numClasses = C;
+  predictions.probabilities.assign(N * C, 0.0);
+  predictions.labels.resize(N);
+  const size_t blocks = (N + Predictor::kRowBlock - 1) / Predictor::kRowBlock;
+  auto scoreBlock = [&](size_t block) {
+    const size_t rowBegin = block * Predictor::kRowBlock, rowEnd = std::min(N, rowBegin + Predictor::kRowBlock);
+    score(rows, rowBegin, rowEnd, predictions.probabilities.data() + rowBegin * C);
+  };
+  if (N * roots_.size() < Predictor::kParallelWork) {
+    for (size_t block = 0; block < blocks; block++)
+      scoreBlock(block);
+  } else {
+    pool.parallelFor(blocks, scoreBlock);
+  }
+  for (size_t r = 0; r < N; r++) {
+    double* probabilities = predictions.probabilities.data() + r * C;
+    for (size_t c = 0; c < C; c++)
+      probabilities[c] /= roots_.size();
+    predictions.labels[r] = std::max_element(probabilities, probabilities + C) - probabilities;
+  }
+  return predictions;
+}
+
+size_t CompactForest::bytes() const {
+  size_t total = nodes_.size() * sizeof(CompactNode)
+    + roots_.size() * sizeof(uint32_t)
+    + categoricalColumns_.size()
+    + categorySets_.size() * sizeof(uint32_t)
+    + categoryWords_.size() * sizeof(uint64_t)
+    + probabilities_.size()
+    + labels_.size() * sizeof(uint16_t);
+  for (const auto& edges: edges_)
+    total += edges.size() * sizeof(int);
+  return total;
+}
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <iomanip>
+#include <sstream>
+#include <boost/timer/timer.hpp>
+#include "CrossValidation.hpp"
+#include "Predictor.hpp"
+
+using boost::timer::cpu_timer;
+
+namespace {
+
+double seconds(const cpu_timer& timer) {
+  return timer.elapsed().wall * 1e-9;
+}
+
+}
+
+std::string ModelConfig::toString() const {
+  std::string depth = tree.maxDepth == std::numeric_limits<int>::max() ? "inf" : std::to_string(tree.maxDepth);
+  std::ostringstream text;
+  text << "trees=" << ensembleSize << " maxDepth=" << depth << " minSamplesSplit=" << tree.minSamplesSplit;
+  // Parameters that change the model are listed when they differ from their
+  // default, so that every configuration of a grid has its own string
+  const TreeParams defaults;
+  if (tree.sketchDepth != defaults.sketchDepth)
+    text << " sketchDepth=" << tree.sketchDepth << " sketchMinRows=" << tree.sketchMinRows;
+  if (tree.smoothing != defaults.smoothing)
+    text << " smoothing=" << tree.smoothing;
+  if (tree.extraTrees != defaults.extraTrees)
+    text << " extraTrees=1";
+  if (tree.maxFeatures != defaults.maxFeatures)
+    text << " maxFeatures=" << tree.maxFeatures;
+  if (tree.subsampleRows != defaults.subsampleRows)
+    text << " subsampleRows=" << tree.subsampleRows << " refineThreshold=" << tree.refineThreshold;
+  if (tree.seed != defaults.seed)
+    text << " seed=" << tree.seed;
+  return text.str();
+}
+
+CrossValidation::CrossValidation(const ColumnStore& store, int folds, uint seed) :
+    store_(store), folds_(folds), seed_(seed) {
+  if (folds < 2 || (size_t) folds > store.numRows())
+    throw std::runtime_error("Cross-validation needs between 2 and #rows folds.");
+  VecIdx rows(store.numRows());
+  std::iota(rows.begin(), rows.end(), 0);
+  std::mt19937_64 random_number_generator(seed);
+  std::shuffle(rows.begin(), rows.end(), random_number_generator);
+  for (size_t i = 0; i < rows.size(); i++)
+    folds_[i % folds].push_back(rows[i]);
+  for (auto& fold: folds_)
+    std::sort(fold.begin(), fold.end());
+}
+
+std::vector<CrossValidationResult> CrossValidation::run(const std::vector<ModelConfig>& grid) const {
+  return run(grid, ThreadPool::shared());
+}
+
+std::vector<CrossValidationResult> CrossValidation::run(const std::vector<ModelConfig>& grid, ThreadPool& pool) const {
+  std::vector<CrossValidationResult> results(grid.size() * folds_.size());
+  pool.parallelFor(results.size(), [&](size_t job) {
+    results[job] = evaluate(grid[job / folds_.size()], job % folds_.size());
+  });
+  return results;
+}
+
+CrossValidationResult CrossValidation::evaluate(const ModelConfig& config, int k) const {
+  // Training rows: every fold but k
+  VecIdx train;
+  for (int f = 0; f < (int) folds_.size(); f++)
+    if (f != k)
+      train.insert(train.end(), folds_[f].begin(), folds_[f].end());
+
+  // Jobs already run in parallel, so trees are learned on the job's thread
+  TreeParams params = config.tree;
+  params.parallelDepth = 0;
+
+  cpu_timer timer;
+  std::vector<Tree> trees;
+  if (config.ensembleSize <= 1) {
+    trees.push_back(TreeBuilder(store_, params).build(train));
+  } else {
+    std::mt19937_64 random_number_generator(seed_ + 7919 * k);
+    std::uniform_int_distribution<size_t> unii(0, train.size() - 1);
+    for (int i = 0; i < config.ensembleSize; i++) {
+      VecIdx sample(train.size());
+      for (auto& r: sample)
+        r = train[unii(random_number_generator)];
+      // Every tree draws its random splits from its own seed, as in Bagging
+      params.seed = Utils::random::mix(config.tree.seed, i);
+      trees.push_back(TreeBuilder(store_, params).build(std::move(sample)));
+    }
+  }
+  const double trainSeconds = seconds(timer);
+
+  timer.start();
+  std::vector<const Tree*> pointers;
+  for (const auto& tree: trees)
+    pointers.push_back(&tree);
+  const Predictor predictor(pointers, store_.numClasses(),
+      config.ensembleSize <= 1 ? Predictor::Voting::Average : Predictor::Voting::Majority);
+  double correct = 0;
+  for (const Idx r: folds_[k])
+    correct += predictor.predict(store_, r) == store_.labels()[r];
+  const double scoreSeconds = seconds(timer);
+
+  return {config, k, correct / folds_[k].size(), trainSeconds, scoreSeconds};
+}
+
+std::vector<ModelConfig> CrossValidation::grid(const VecI& ensembleSizes, const VecI& maxDepths, const VecI& minSamplesSplits) {
+  std::vector<ModelConfig> configs;
+  for (const int ensembleSize: ensembleSizes)
+    for (const int maxDepth: maxDepths)
+      for (const int minSamplesSplit: minSamplesSplits) {
+        ModelConfig config;
+        config.ensembleSize = ensembleSize;
+        config.tree.maxDepth = maxDepth;
+        config.tree.minSamplesSplit = minSamplesSplit;
+        configs.push_back(config);
+      }
+  return configs;
+}
+
+void CrossValidation::print(const std::vector<CrossValidationResult>& results, std::ostream& out) {
+  // Formatted apart, so that the caller's stream keeps its own format
+  std::ostringstream text;
+  text << std::fixed << std::setprecision(4);
+  for (const auto& result: results)
+    text << result.config.toString() << "\tfold=" << result.fold << "\taccuracy=" << result.accuracy
+        << "\ttrain=" << result.trainSeconds << "s\tscore=" << result.scoreSeconds << "s\n";
+
+  text << "Mean per configuration:\n";
+  std::vector<std::string> order;
+  std::unordered_map<std::string, std::vector<const CrossValidationResult*>> byConfig;
+  for (const auto& result: results) {
+    const std::string key = result.config.toString();
+    if (byConfig.find(key) == std::end(byConfig))
+      order.push_back(key);
+    byConfig[key].push_back(&result);
+  }
+  for (const auto& key: order) {
+    double accuracy = 0, train = 0;
+    for (const auto* result: byConfig.at(key)) {
+      accuracy += result->accuracy;
+      train += result->trainSeconds;
+    }
+    const double n = byConfig.at(key).size();
+    text << key << "\taccuracy=" << accuracy / n << "\ttrain=" << train / n << "s\n";
+  }
+  out << text.str();
+}
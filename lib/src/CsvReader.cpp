@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cstdlib>
+#include <stdexcept>
+#include "CsvReader.hpp"
+
+namespace {
+
+const char* kWhiteSpace = " \t\r\n";
+
+bool isBlank(const std::string& line) {
+  return line.find_first_not_of(kWhiteSpace) == std::string::npos;
+}
+
+// Parses the whole of value as a number
+bool parseNumber(const std::string& value, int& number) {
+  if (value.empty())
+    return false;
+  char* end;
+  const double parsed = std::strtod(value.c_str(), &end);
+  if (end != value.c_str() + value.size())
+    return false;
+  number = parsed;
+  return true;
+}
+
+}
+
+CsvReader::CsvReader(const std::string& classLabel, char delimiter) :
+    classLabel_(classLabel), delimiter_(delimiter) {}
+
+ColumnStore CsvReader::read(const std::string& filename) const {
+  MetaData meta;
+  std::vector<VecI> columns;
+  read(filename, meta, columns);
+  return ColumnStore(meta, std::move(columns));
+}
+
+ColumnStore CsvReader::read(const std::string& filename, const MetaData& reference) const {
+  MetaData meta = reference;
+  std::vector<VecI> columns;
+  read(filename, meta, columns);
+  return ColumnStore(meta, std::move(columns));
+}
+
+void CsvReader::read(const std::string& filename, MetaData& meta, std::vector<VecI>& columns) const {
+  const bool infer = meta.labels.empty();
+  if (readPass(filename, meta, columns, infer))
+    return;
+  // A column became categorical halfway; read again with the final types
+  MetaData inferred;
+  inferred.labels = meta.labels;
+  inferred.types = meta.types;
+  meta = inferred;
+  readPass(filename, meta, columns, false);
+}
+
+bool CsvReader::readPass(const std::string& filename, MetaData& meta, std::vector<VecI>& columns, bool infer) const {
+  std::ifstream file(filename);
+  if (!file)
+    throw std::runtime_error("Can't open file: " + filename);
+
+  std::string line;
+  VecS fields;
+  size_t lineNumber = 0;
+  while (std::getline(file, line) && isBlank(line))
+    lineNumber++;
+  lineNumber++;
+  split(line, fields);
+  if (fields.empty())
+    throw std::runtime_error("Missing header in " + filename);
+
+  // Column of meta that every field is stored in, -1 to skip
+  VecI target(fields.size(), -1);
+  if (infer) {
+    const auto found = std::find(fields.begin(), fields.end(), classLabel_);
+    const size_t classField = classLabel_.empty() || found == fields.end() ? fields.size() - 1 : found - fields.begin();
+    for (size_t i = 0; i < fields.size(); i++) {
+      if (i == classField)
+        continue;
+      target[i] = meta.labels.size();
+      meta.labels.push_back(fields[i]);
+      meta.types.push_back("NUMERIC");
+    }
+    target[classField] = meta.labels.size();
+    meta.labels.push_back(fields[classField]);
+    meta.types.push_back("CATEGORICAL");
+  } else {
+    for (size_t i = 0; i < fields.size(); i++)
+      for (size_t l = 0; l < meta.labels.size(); l++)
+        if (meta.labels[l] == fields[i])
+          target[i] = l;
+    for (size_t l = 0; l < meta.labels.size(); l++)
+      if (std::find(target.begin(), target.end(), (int) l) == target.end())
+        throw std::runtime_error("Column '" + meta.labels[l] + "' is missing from " + filename);
+  }
+
+  columns.assign(meta.labels.size(), VecI());
+  bool consistent = true;
+  while (std::getline(file, line)) {
+    lineNumber++;
+    if (isBlank(line))
+      continue;
+    split(line, fields);
+    if (fields.size() != target.size())
+      throw std::runtime_error("Expected " + std::to_string(target.size()) + " values on line "
+          + std::to_string(lineNumber) + " of " + filename);
+    for (size_t i = 0; i < fields.size(); i++) {
+      const int c = target[i];
+      if (c < 0)
+        continue;
+      int value;
+      if (meta.types[c] == "NUMERIC") {
+        if (parseNumber(fields[i], value)) {
+          columns[c].push_back(value);
+          continue;
+        }
+        if (!infer)
+          throw std::runtime_error("Can't parse '" + fields[i] + "' on line " + std::to_string(lineNumber)
+              + " of " + filename);
+        meta.types[c] = "CATEGORICAL";
+        consistent = consistent && columns[c].empty();
+      }
+      columns[c].push_back(meta.encode(meta.labels[c], fields[i]));
+    }
+  }
+  return consistent;
+}
+
+void CsvReader::split(const std::string& line, VecS& fields) const {
+  fields.clear();
+  std::string field;
+  bool quoted = false;
+  for (size_t i = 0; i <= line.size(); i++) {
+    const char ch = i < line.size() ? line[i] : delimiter_;
+    if (quoted) {
+      if (ch == '"' && i + 1 < line.size() && line[i + 1] == '"') {
+        field += '"';
+        i++;
+      } else if (ch == '"') {
+        quoted = false;
+      } else {
+        field += ch;
+      }
+    } else if (ch == '"') {
+      quoted = true;
+    } else if (ch == delimiter_) {
+      const size_t first = field.find_first_not_of(kWhiteSpace);
+      const size_t last = field.find_last_not_of(kWhiteSpace);
+      fields.push_back(first == std::string::npos ? std::string() : field.substr(first, last - first + 1));
+      field.clear();
+    } else {
+      field += ch;
+    }
+  }
+}
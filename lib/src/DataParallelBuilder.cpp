@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include "Calculations.hpp"
+#include "DataParallelBuilder.hpp"
+#include "Numa.hpp"
+
+namespace {
+
+// Nodes with at least this many rows in the shard count their features in parallel
+constexpr size_t kParallelHistogramRows = size_t(1) << 16;
+
+}
+
+DataParallelBuilder::DataParallelBuilder(const ColumnStore& shard, Communicator& comm, const TreeParams& params, int maxBins) :
+    store_(shard), comm_(comm), params_(params), numClasses_(0), cuts_(shard.numFeatures()),
+    offset_(shard.numFeatures() + 1, 0), bins_(shard.numFeatures()) {
+  if (maxBins < 2 || maxBins > std::numeric_limits<uint16_t>::max())
+    throw std::runtime_error("The number of bins must be between 2 and 65535.");
+  const int F = store_.numFeatures();
+
+  // Global range of the numeric features and number of categories and
+  // classes, as minima: the maxima enter negated
+  std::vector<int64_t> extremes(2 * F + 1);
+  for (int f = 0; f < F; f++) {
+    int64_t lo = std::numeric_limits<int>::max(), hi = std::numeric_limits<int>::min();
+    if (store_.isNumeric(f)) {
+      for (Idx r = 0; r < store_.numRows(); r++) {
+        const int64_t v = store_.value(f, r);
+        lo = std::min(lo, v);
+        hi = std::max(hi, v);
+      }
+    } else {
+      hi = store_.numCategories(f);
+    }
+    extremes[f] = lo;
+    extremes[F + f] = -hi;
+  }
+  extremes[2 * F] = -store_.numClasses();
+  comm_.allReduce(extremes, Communicator::Op::Min);
+  numClasses_ = -extremes[2 * F];
+
+  for (int f = 0; f < F; f++) {
+    const int64_t lo = extremes[f], hi = -extremes[F + f];
+    size_t numBins = 0;
+    if (!store_.isNumeric(f)) {
+      numBins = std::max<int64_t>(hi, 1);
+    } else {
+      const int64_t range = hi - lo + 1;
+      if (range > maxBins) {
+        for (int b = 1; b < maxBins; b++)
+          cuts_[f].push_back(lo + (range * b + maxBins - 1) / maxBins);
+      } else {
+        for (int64_t v = lo + 1; v <= hi; v++)
+          cuts_[f].push_back(v);
+      }
+      numBins = cuts_[f].size() + 1;
+    }
+    offset_[f + 1] = offset_[f] + numBins * numClasses_;
+
+    bins_[f].resize(store_.numRows());
+    for (Idx r = 0; r < store_.numRows(); r++) {
+      const int v = store_.value(f, r);
+      bins_[f][r] = store_.isNumeric(f)
+        ? std::upper_bound(cuts_[f].begin(), cuts_[f].end(), v) - cuts_[f].begin()
+        : v;
+    }
+  }
+}
+
+Tree DataParallelBuilder::build() {
+  VecIdx rows(store_.numRows());
+  std::iota(rows.begin(), rows.end(), 0);
+  Tree tree;
+  TreeStats stats(store_.numFeatures());
+  tree.setRoot(buildTree(tree, stats, RowView{rows.data(), rows.data() + rows.size()}, 0));
+  tree.setStats(std::move(stats));
+  tree.computeProbabilities(OutputLayout::single(numClasses_), params_.smoothing);
+  return tree;
+}
+
+void DataParallelBuilder::histogram(RowView rows, VecI& counts) const {
+  const int F = store_.numFeatures();
+  const VecI& labels = store_.labels();
+  counts.assign(offset_[F], 0);
+  auto count = [&](size_t f) {
+    int* hist = counts.data() + offset_[f];
+    const uint16_t* bin = bins_[f].data();
+    for (const Idx r: rows)
+      hist[bin[r] * numClasses_ + labels[r]]++;
+  };
+  if (rows.size() >= kParallelHistogramRows && F > 1) {
+    NumaPools::shared().parallelFor(F, [this](size_t f) { return store_.columnNode(f); }, count);
+  } else {
+    for (int f = 0; f < F; f++)
+      count(f);
+  }
+}
+
+NodeId DataParallelBuilder::buildTree(Tree& tree, TreeStats& stats, RowView rows, int depth) {
+  const int F = store_.numFeatures();
+  ClassTally tally(numClasses_, 0);
+  for (const Idx r: rows)
+    tally[store_.labels()[r]]++;
+  comm_.allReduce(tally);
+  int N = 0;
+  for (const int c: tally)
+    N += c;
+  const double gini_node = Calculations::gini(tally, N);
+
+  double best_gain = 0;
+  Question best_question;
+  // Histograms only for nodes that can split, a pure node has nothing to gain
+  if (depth < params_.maxDepth && N >= params_.minSamplesSplit && gini_node > 0) {
+    VecI counts;
+    histogram(rows, counts);
+    comm_.allReduce(counts);
+    VecI subset;
+    for (int f = 0; f < F; f++) {
+      const int* hist = counts.data() + offset_[f];
+      if (store_.isNumeric(f)) {
+        const auto [threshold, loss] = Calculations::determine_best_threshold_binned(hist, cuts_[f], numClasses_);
+        if (gini_node - loss > best_gain) {
+          best_gain = gini_node - loss;
+          best_question = Question(f, threshold, store_.meta());
+        }
+      } else {
+        const int numBins = (offset_[f + 1] - offset_[f]) / numClasses_;
+        const double loss = Calculations::determine_best_subset_counts(hist, numBins, numClasses_, subset);
+        if (gini_node - loss > best_gain) {
+          best_gain = gini_node - loss;
+          best_question = Question(f, subset, store_.meta());
+        }
+      }
+    }
+  }
+
+  if (best_gain == 0) {
+    ClassCounter clsCounter;
+    for (int c = 0; c < numClasses_; c++)
+      if (tally[c] > 0)
+        clsCounter[c] = tally[c];
+    const NodeId leaf = tree.addLeaf(clsCounter);
+    stats.addNode(leaf, N);
+    return leaf;
+  }
+  auto [true_rows, false_rows] = Calculations::partition(store_, rows, best_question);
+  const NodeId trueBranch = buildTree(tree, stats, true_rows, depth + 1);
+  const NodeId falseBranch = buildTree(tree, stats, false_rows, depth + 1);
+  const NodeId node = tree.addNode(trueBranch, falseBranch, best_question);
+  stats.addSplit(best_question.column_, best_gain, N);
+  stats.addNode(node, N);
+  return node;
+}
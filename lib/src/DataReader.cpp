@@ -4,61 +4,151 @@
  * Written by Pieter Robberechts, 2019
  */
 
-#include <thread>
+#include <strings.h>
+#include "CsvReader.hpp"
 #include "DataReader.hpp"
 
 using boost::algorithm::split;
 using boost::timer::cpu_timer;
 
+namespace {
+
+bool isCsv(const std::string& filename) {
+  const std::string extension = ".csv";
+  return filename.size() >= extension.size()
+    && strcasecmp(filename.c_str() + filename.size() - extension.size(), extension.c_str()) == 0;
+}
+
+}
+
 DataReader::DataReader(const Dataset& dataset) :
     classLabel_(dataset.classLabel),
+    sketchEpsilon_(dataset.sketchEpsilon),
+    reduceFeatures_(dataset.reduceFeatures),
     trainData_({}),
     backupTrainData_({}),
     testData_({}),
     trainMetaData_({}),
-    testMetaData_({}) {
+    testMetaData_({}),
+    dMapIS_(),
+    columns_() {
   std::cout << "Start reading data set." << std::endl; cpu_timer timer;
-  std::thread readTestingData([this, &dataset]() {
-    return processFile(dataset.train.filename, trainData_, trainMetaData_);
-  });
-
-  std::thread readTrainingData([this, &dataset]() {
-    return processFile(dataset.test.filename, testData_, testMetaData_);
-  });
+  if (isCsv(dataset.train.filename)) {
+    readCsv(dataset);
+    std::cout << "Done. " << timer.format() << std::endl;
+    buildColumns();
+    return;
+  }
 
-  readTrainingData.join();
-  readTestingData.join();
+  // Headers are short and read first; the data sections of both files then
+  // go through one pipeline, so that all cores work on them together
+  std::vector<ArffPipeline::Input> inputs;
+  readHeader(dataset.train.filename, trainMetaData_, trainData_, inputs);
+  // Without a test file the test set is left empty, e.g. to stream it later.
+  // The test header starts from the training codes, so that the values it
+  // declares keep the codes they have in training
+  if (!dataset.test.filename.empty()) {
+    testMetaData_.dMapSI = trainMetaData_.dMapSI;
+    testMetaData_.dMapIS = trainMetaData_.dMapIS;
+    readHeader(dataset.test.filename, testMetaData_, testData_, inputs);
+  }
+  ArffPipeline().run(inputs);
+  alignTestCodes();
   std::cout << "Done. " << timer.format() << std::endl;
 
-  if (!classLabel_.empty())
-    moveClassLabelToBack();
-
   if (trainData_.empty())
     throw std::runtime_error("Can't open file: " + dataset.train.filename);
 
-  if (testData_.empty())
+  if (testData_.empty() && !dataset.test.filename.empty())
     throw std::runtime_error("Can't open file: " + dataset.test.filename);
+
+  buildColumns();
+}
+
+void DataReader::readCsv(const Dataset& dataset) {
+  // The test file is encoded with the types and codes inferred from the
+  // training file, so the two are read one after the other
+  const CsvReader reader(classLabel_);
+  std::vector<VecI> columns;
+  reader.read(dataset.train.filename, trainMetaData_, columns);
+  toRows(columns, trainData_);
+  if (trainData_.empty())
+    throw std::runtime_error("No data in file: " + dataset.train.filename);
+  testMetaData_ = trainMetaData_;
+  if (!dataset.test.filename.empty()) {
+    reader.read(dataset.test.filename, testMetaData_, columns);
+    toRows(columns, testData_);
+  }
+}
+
+void DataReader::alignTestCodes() {
+  // Values missing from the headers are appended to the training and test
+  // codes side by side, so the same new code may stand for different values
+  // in the two files. Test values are recoded to their training code, and
+  // values unseen in training to codes after all training codes.
+  for (size_t c = 0; c < testMetaData_.labels.size(); c++) {
+    if (testMetaData_.types[c] != "CATEGORICAL")
+      continue;
+    const std::string& label = testMetaData_.labels[c];
+    const auto trainCodes = trainMetaData_.dMapSI.find(label);
+    const auto trainValues = trainMetaData_.dMapIS.find(label);
+    MapSI codes = trainCodes == trainMetaData_.dMapSI.end() ? MapSI() : trainCodes->second;
+    MapIS values = trainValues == trainMetaData_.dMapIS.end() ? MapIS() : trainValues->second;
+    const MapIS& testValues = testMetaData_.dMapIS[label];
+    VecI recode(testValues.size());
+    bool same = true;
+    for (int code = 0; code < (int) testValues.size(); code++) {
+      const std::string& value = testValues.at(code);
+      const auto found = codes.find(value);
+      if (found != codes.end()) {
+        recode[code] = found->second;
+      } else {
+        recode[code] = codes.size();
+        codes.emplace(value, recode[code]);
+        values[recode[code]] = value;
+      }
+      same = same && recode[code] == code;
+    }
+    testMetaData_.dMapSI[label] = std::move(codes);
+    testMetaData_.dMapIS[label] = std::move(values);
+    if (!same)
+      for (auto& row: testData_)
+        row[c] = recode[row[c]];
+  }
+}
+
+void DataReader::toRows(const std::vector<VecI>& columns, Data& data) {
+  const size_t n = columns.empty() ? 0 : columns.front().size();
+  data.assign(n, VecI(columns.size()));
+  for (size_t c = 0; c < columns.size(); c++)
+    for (size_t r = 0; r < n; r++)
+      data[r][c] = columns[c][r];
 }
 
-void DataReader::processFile(const std::string& filename, Data& data, MetaData &meta) {
-  std::ifstream file(filename);
+void DataReader::buildColumns() {
+  auto columns = std::make_shared<ColumnStore>(trainData_, trainMetaData_);
+  if (sketchEpsilon_ > 0)
+    columns->buildSketches(sketchEpsilon_);
+  if (reduceFeatures_)
+    columns->reduceFeatures();
+  columns_ = std::move(columns);
+}
+
+void DataReader::readHeader(const std::string& filename, MetaData& meta, Data& data,
+    std::vector<ArffPipeline::Input>& inputs) const {
+  std::ifstream file(filename, std::ios::binary);
   if (!file)
     return;
 
   std::string line;
   bool header_loaded = false;
-
-  while (getline(file, line)) {
-    if (!header_loaded) {
-      parseHeaderLine(line, meta, header_loaded);
-    } else {
-      parseDataLine(line, data, meta);
-    }
-  }
-  file.close();
+  while (!header_loaded && getline(file, line))
+    parseHeaderLine(line, meta, header_loaded);
+  if (header_loaded)
+    inputs.push_back({filename, file.tellg(), moveClassLabelToBack(meta), &meta, &data});
 }
 
-bool DataReader::parseHeaderLine(const std::string &line, MetaData &meta, bool &header_loaded) {
+bool DataReader::parseHeaderLine(const std::string &line, MetaData &meta, bool &header_loaded) const {
   if (line.size() == 0) {
     return true;
   }
@@ -107,9 +197,17 @@ bool DataReader::parseHeaderLine(const std::string &line, MetaData &meta, bool &
 
     {
       int pos = s.find_last_of("{");
+      VecS values;
+      if (pos != (int) s.npos)
+        split(values, s.substr(pos + 1, s.find_last_of("}") - pos - 1), boost::is_any_of(","));
+      trimWhiteSpaces(values);
       s = s.substr(0, pos);
       meta.labels.push_back(s);
       meta.types.push_back("CATEGORICAL");
+      // Declared values get dense codes in declaration order, after the
+      // codes the metadata already holds
+      for (const auto& value: values)
+        meta.encode(s, value);
       return true;
     }
     return true;
@@ -130,59 +228,19 @@ bool DataReader::parseHeaderLine(const std::string &line, MetaData &meta, bool &
   return true;
 }
 
-bool DataReader::parseDataLine(const std::string &line, Data &data, MetaData &meta) {
-  VecS vecS;
-  VecI vecI;
-  split(vecS, line, boost::is_any_of(","));
-  trimWhiteSpaces(vecS);
-
-  if (!classLabel_.empty()) {
-    moveClassDataToBack(vecS, meta.labels);
-  }
-
-  // Map strings to integers
-  std::hash<std::string> hasher;
-  MapIS mapIS;
-  for(int i=0; i<vecS.size(); i++){
-    if(meta.types[i]=="NUMERIC"){
-      // Convert to int
-      vecI.push_back(std::stod(vecS[i]));
-    }
-    else if(meta.types[i]=="CATEGORICAL"){
-      // Hash
-      int hash = hasher(vecS[i]);
-      vecI.push_back(hash);
-      // Store the mapping
-      if(meta.dMapIS.find(meta.labels[i]) == std::end(meta.dMapIS)){
-        meta.dMapIS[meta.labels[i]] = mapIS;
-      }
-      if (meta.dMapIS.at(meta.labels[i]).find(hash) == std::end(meta.dMapIS.at(meta.labels[i]))) {
-        meta.dMapIS.at(meta.labels[i])[hash] = vecS[i];
-      } 
-    }
-    else {
-      throw std::runtime_error("Attribute type is neither NUMERICAL nor CATEGORICAL.");
-    }
-  }
-
-  // Store line to data object
-  data.emplace_back(std::move(vecI));
-
-  return true;
-}
-
-void DataReader::moveClassLabelToBack() {
-  const auto result = std::find(std::begin(trainMetaData_.labels), std::end(trainMetaData_.labels), classLabel_);
-  if (result != std::end(metaData().labels))
-    std::iter_swap(result, std::end(trainMetaData_.labels)-1);
-}
-
-void DataReader::moveClassDataToBack(VecS &line, const VecS &labels) const{
-  static const auto result = std::find(std::begin(labels), std::end(labels), classLabel_);
-  if (result != std::end(labels)) {
-    static const auto result_index = std::distance(std::begin(labels), result);
-    std::iter_swap(std::begin(line)+result_index, std::end(line)-1);
+VecI DataReader::moveClassLabelToBack(MetaData& meta) const {
+  // Each file gets its own mapping, from its own header
+  VecI fieldOf(meta.labels.size());
+  std::iota(fieldOf.begin(), fieldOf.end(), 0);
+  const auto result = std::find(meta.labels.begin(), meta.labels.end(), classLabel_);
+  if (!classLabel_.empty() && result != meta.labels.end()) {
+    const size_t index = std::distance(meta.labels.begin(), result);
+    const size_t last = meta.labels.size() - 1;
+    std::swap(meta.labels[index], meta.labels[last]);
+    std::swap(meta.types[index], meta.types[last]);
+    std::swap(fieldOf[index], fieldOf[last]);
   }
+  return fieldOf;
 }
 
 void DataReader::trimWhiteSpaces(VecS &line) {
@@ -3,62 +3,68 @@
  * Proprietary, do not copy or distribute without permission. 
  * Written by Pieter Robberechts, 2019
  */
-#include <thread>
-#include <future>
-
 #include "DecisionTree.hpp"
 #include "Calculations.hpp"
+#include "FeatureImportance.hpp"
+#include "Predictor.hpp"
 
-using std::make_shared;
-using std::shared_ptr;
 using std::string;
 using boost::timer::cpu_timer;
 
-DecisionTree::DecisionTree(const DataReader& dr) : root_(Node()), dr_(dr) {
-  std::cout << "Start building tree." << std::endl; cpu_timer timer;
-  root_ = buildTree(dr_.trainData(), dr_.metaData());
-  std::cout << "Done. " << timer.format() << std::endl;
+namespace {
+
+VecIdx allRows(const DataReader& dr) {
+  VecIdx rows(dr.trainData().size());
+  std::iota(rows.begin(), rows.end(), 0);
+  return rows;
 }
 
-const Node DecisionTree::buildTree(const Data& rows, const MetaData& meta) {
-  auto [gain, question] = Calculations::find_best_split(rows, meta);
-  if(gain == 0){
-    ClassCounter clsCounter = Calculations::classCounts(rows);
-    return Node(Leaf(clsCounter));
-  }
-  else {
-    auto [true_rows, false_rows] = Calculations::partition(rows, question);
-    // std::cout << question.toString(meta) << std::endl;
-    // std::cout << "True branch: " << true_rows[0].size() << ", False branch: " << false_rows[0].size() << std::endl;
-    auto retTrue = std::async(&DecisionTree::buildTree, this, true_rows, meta);
-    auto retFalse = std::async(&DecisionTree::buildTree, this, false_rows, meta);
-    Node trueBranch = retTrue.get();
-    true_rows.clear();
-    Node falseBranch = retFalse.get();
-    false_rows.clear();
-    return Node(trueBranch, falseBranch, question);
-  }
+}
+
+DecisionTree::DecisionTree(const DataReader& dr) :
+    dr_(dr), tree_(build(dr_, allRows(dr_), TreeParams())) {}
+
+DecisionTree::DecisionTree(const DataReader& dr, const std::vector<size_t>& samples) :
+    DecisionTree(dr, samples, TreeParams()) {}
+
+DecisionTree::DecisionTree(const DataReader& dr, const std::vector<size_t>& samples, const TreeParams& params) :
+    dr_(dr), tree_(build(dr_, VecIdx(samples.begin(), samples.end()), params)) {}
+
+Tree DecisionTree::build(const DataReader& dr, VecIdx rows, const TreeParams& params) {
+  std::cout << "Start building tree." << std::endl; cpu_timer timer;
+  Tree tree = TreeBuilder(dr.columns(), params).build(std::move(rows));
+  std::cout << "Done. " << timer.format() << std::endl;
+  return tree;
 }
 
 void DecisionTree::print() const {
-  print(make_shared<Node>(root_));
+  print(tree_, dr_.metaData(), tree_.root());
 }
 
-void DecisionTree::print(const shared_ptr<Node> root, string spacing) const {
-  if (bool is_leaf = root->leaf() != nullptr; is_leaf) {
-    const auto &leaf = root->leaf();
-    std::cout << spacing + "Predict: "; Utils::print::print_map(leaf->predictions(), dr_.metaData());
+void DecisionTree::print(const Tree& tree, const MetaData& meta, NodeId id, string spacing) {
+  const Node& node = tree.node(id);
+  if (node.isLeaf()) {
+    const auto &leaf = tree.leaf(node);
+    std::cout << spacing + "Predict: "; Utils::print::print_map(leaf.predictions(), meta);
     return;
   }
-  std::cout << spacing << root->question().toString(dr_.metaData()) << "\n";
+  std::cout << spacing << node.question().toString(meta) << "\n";
 
   std::cout << spacing << "--> True: " << "\n";
-  print(root->trueBranch(), spacing + "   ");
+  print(tree, meta, node.trueBranch(), spacing + "   ");
 
   std::cout << spacing << "--> False: " << "\n";
-  print(root->falseBranch(), spacing + "   ");
+  print(tree, meta, node.falseBranch(), spacing + "   ");
 }
 
 void DecisionTree::test() const {
-  TreeTest t(dr_.testData(), dr_.metaData(), root_);
+  TreeTest t(dr_.testData(), dr_.metaData(), tree_);
+}
+
+std::vector<double> DecisionTree::featureImportance() const {
+  return tree_.stats().importance();
+}
+
+std::vector<double> DecisionTree::permutationImportance(const Data& data, int repeats, uint seed) const {
+  return FeatureImportance::permutation(Predictor(*this), data, repeats, seed);
 }
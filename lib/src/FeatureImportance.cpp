@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <iomanip>
+#include <random>
+#include "FeatureImportance.hpp"
+
+std::vector<double> FeatureImportance::impurity(const std::vector<const Tree*>& trees, int numFeatures) {
+  std::vector<double> importance(numFeatures, 0.0);
+  for (const Tree* tree: trees) {
+    const std::vector<double> ofTree = tree->stats().importance();
+    for (size_t f = 0; f < ofTree.size(); f++)
+      importance[f] += ofTree[f] / trees.size();
+  }
+  return importance;
+}
+
+std::vector<double> FeatureImportance::permutation(const Predictor& predictor, const Data& data, int repeats, uint seed) {
+  if (data.empty())
+    return {};
+  const size_t F = data.front().size() - 1;
+  std::vector<double> importance(F, 0.0);
+  const double baseline = predictor.predict(data).accuracy(data);
+
+  // One working copy; a single column of it is shuffled at a time
+  Data shuffled = data;
+  VecIdx order(data.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::mt19937_64 random_number_generator(seed);
+  for (size_t f = 0; f < F; f++) {
+    for (int k = 0; k < repeats; k++) {
+      std::shuffle(order.begin(), order.end(), random_number_generator);
+      for (size_t r = 0; r < data.size(); r++)
+        shuffled[r][f] = data[order[r]][f];
+      importance[f] += (baseline - predictor.predict(shuffled).accuracy(data)) / repeats;
+    }
+    for (size_t r = 0; r < data.size(); r++)
+      shuffled[r][f] = data[r][f];
+  }
+  return importance;
+}
+
+void FeatureImportance::print(const std::vector<double>& importance, const MetaData& meta, std::ostream& out) {
+  VecIdx order(importance.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](Idx a, Idx b) {
+    return importance[a] > importance[b];
+  });
+  for (const Idx f: order)
+    out << std::setw(24) << std::left << meta.labels[f] << " " << importance[f] << "\n";
+  out << std::flush;
+}
@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cmath>
+#include "HoeffdingTree.hpp"
+#include "Calculations.hpp"
+#include "DecisionTree.hpp"
+#include "TreeTest.hpp"
+
+namespace {
+
+// Weighted gini of a binary split, given the class counts of the true branch
+// and of the whole node
+double splitGini(const VecI& trueCounts, const VecI& allCounts, VecI& falseCounts) {
+  int nTrue = 0, N = 0;
+  for (size_t c = 0; c < allCounts.size(); c++) {
+    falseCounts[c] = allCounts[c] - trueCounts[c];
+    nTrue += trueCounts[c];
+    N += allCounts[c];
+  }
+  const int nFalse = N - nTrue;
+  if (nTrue == 0 || nFalse == 0)
+    return std::numeric_limits<double>::infinity();
+  return Calculations::gini(trueCounts, nTrue) * nTrue / N + Calculations::gini(falseCounts, nFalse) * nFalse / N;
+}
+
+}
+
+HoeffdingTree::HoeffdingTree(const MetaData& meta, const HoeffdingParams& params) :
+    meta_(meta),
+    params_(params),
+    numFeatures_(meta.labels.size() - 1),
+    numClasses_(0),
+    numeric_(),
+    nodes_(),
+    leaves_(),
+    rowsSeen_(0) {
+  const auto classes = meta.dMapIS.find(meta.labels.back());
+  numClasses_ = classes != std::end(meta.dMapIS) ? classes->second.size() : 0;
+  if (numClasses_ < 1)
+    throw std::runtime_error("The class attribute must declare its values.");
+  for (int f = 0; f < numFeatures_; f++)
+    numeric_.push_back(meta.types[f] == "NUMERIC");
+  newLeaf(VecI(numClasses_, 0), 0);
+}
+
+int HoeffdingTree::newLeaf(const VecI& classCounts, int depth, int slot) {
+  LeafStats stats;
+  stats.classCounts = classCounts;
+  stats.seenCounts.assign(numClasses_, 0);
+  stats.numeric.resize(numFeatures_);
+  stats.categorical.resize(numFeatures_);
+  if (slot < 0) {
+    slot = leaves_.size();
+    leaves_.push_back(std::move(stats));
+  } else {
+    leaves_[slot] = std::move(stats);
+  }
+  nodes_.push_back({Question(), -1, -1, slot, depth});
+  return nodes_.size() - 1;
+}
+
+int HoeffdingTree::leafOf(const VecI& row) const {
+  int id = 0;
+  while (nodes_[id].leaf < 0)
+    id = nodes_[id].question.solve(row) ? nodes_[id].trueBranch : nodes_[id].falseBranch;
+  return id;
+}
+
+void HoeffdingTree::update(const Data& rows) {
+  for (const auto& row: rows)
+    update(row);
+}
+
+void HoeffdingTree::update(const VecI& row) {
+  const int label = row.back();
+  if (label < 0 || label >= numClasses_)
+    throw std::runtime_error("Row without a known class label.");
+  const int id = leafOf(row);
+  LeafStats& stats = leaves_[nodes_[id].leaf];
+  add(stats, row);
+  rowsSeen_++;
+  if (stats.seen - stats.lastCheck >= params_.gracePeriod && nodes_[id].depth < params_.maxDepth)
+    attemptSplit(id);
+}
+
+void HoeffdingTree::add(LeafStats& stats, const VecI& row) const {
+  const int label = row.back();
+  stats.classCounts[label]++;
+  stats.seenCounts[label]++;
+  stats.seen++;
+  for (int f = 0; f < numFeatures_; f++) {
+    const int value = row[f];
+    if (numeric_[f]) {
+      addNumeric(stats.numeric[f], value, label);
+    } else if (value >= 0) {
+      // Unknown categories (-1) are not counted
+      VecI& counts = stats.categorical[f];
+      if ((size_t) (value + 1) * numClasses_ > counts.size())
+        counts.resize((value + 1) * numClasses_, 0);
+      counts[value * numClasses_ + label]++;
+    }
+  }
+}
+
+void HoeffdingTree::addNumeric(Histogram& histogram, int value, int label) const {
+  // The bin whose range holds the value, if any
+  const auto after = std::upper_bound(histogram.values.begin(), histogram.values.end(), value);
+  size_t i = after - histogram.values.begin();
+  if (i > 0 && value <= histogram.uppers[i - 1]) {
+    i--;
+  } else {
+    histogram.values.insert(after, value);
+    histogram.uppers.insert(histogram.uppers.begin() + i, value);
+    histogram.counts.insert(histogram.counts.begin() + i * numClasses_, numClasses_, 0);
+    histogram.totals.insert(histogram.totals.begin() + i, 0);
+  }
+  histogram.counts[i * numClasses_ + label]++;
+  histogram.totals[i]++;
+
+  if ((int) histogram.values.size() <= params_.maxBins)
+    return;
+  // Merge the lightest pair of neighbours into the lower bin, which then
+  // covers both ranges; the threshold at the upper bin is dropped
+  size_t lightest = 0;
+  for (size_t j = 1; j + 1 < histogram.values.size(); j++)
+    if (histogram.totals[j] + histogram.totals[j + 1] < histogram.totals[lightest] + histogram.totals[lightest + 1])
+      lightest = j;
+  for (int c = 0; c < numClasses_; c++)
+    histogram.counts[lightest * numClasses_ + c] += histogram.counts[(lightest + 1) * numClasses_ + c];
+  histogram.totals[lightest] += histogram.totals[lightest + 1];
+  histogram.uppers[lightest] = histogram.uppers[lightest + 1];
+  histogram.values.erase(histogram.values.begin() + lightest + 1);
+  histogram.uppers.erase(histogram.uppers.begin() + lightest + 1);
+  histogram.counts.erase(histogram.counts.begin() + (lightest + 1) * numClasses_,
+      histogram.counts.begin() + (lightest + 2) * numClasses_);
+  histogram.totals.erase(histogram.totals.begin() + lightest + 1);
+}
+
+HoeffdingTree::Candidate HoeffdingTree::bestNumeric(const LeafStats& stats, int f) const {
+  Candidate best;
+  const Histogram& histogram = stats.numeric[f];
+  if (histogram.values.size() < 2)
+    return best;
+  const double giniNode = Calculations::gini(stats.seenCounts, stats.seen);
+  VecI trueCounts = stats.seenCounts, falseCounts(numClasses_);
+  // Values below the threshold move to the false branch one by one
+  for (size_t k = 1; k < histogram.values.size(); k++) {
+    for (int c = 0; c < numClasses_; c++)
+      trueCounts[c] -= histogram.counts[(k - 1) * numClasses_ + c];
+    const double gain = giniNode - splitGini(trueCounts, stats.seenCounts, falseCounts);
+    if (gain > best.gain) {
+      best.gain = gain;
+      best.question = Question(f, histogram.values[k], meta_);
+      best.trueCounts = trueCounts;
+    }
+  }
+  return best;
+}
+
+HoeffdingTree::Candidate HoeffdingTree::bestCategorical(const LeafStats& stats, int f) const {
+  Candidate best;
+  const VecI& counts = stats.categorical[f];
+  const int numCategories = counts.size() / numClasses_;
+  VecI present, sizes(numCategories, 0);
+  for (int v = 0; v < numCategories; v++) {
+    for (int c = 0; c < numClasses_; c++)
+      sizes[v] += counts[v * numClasses_ + c];
+    if (sizes[v] > 0)
+      present.push_back(v);
+  }
+  if (present.size() < 2)
+    return best;
+  // Unknown categories are not counted, so the node is made up of the
+  // counted rows only
+  VecI allCounts(numClasses_, 0);
+  for (const int v: present)
+    for (int c = 0; c < numClasses_; c++)
+      allCounts[c] += counts[v * numClasses_ + c];
+  const double giniNode = Calculations::gini(allCounts, std::accumulate(sizes.begin(), sizes.end(), 0));
+  VecI trueCounts(numClasses_), falseCounts(numClasses_), order;
+  for (int target = (numClasses_ > 2 ? 0 : 1); target < numClasses_; target++) {
+    order = present;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+      const int64_t pa = int64_t(counts[a * numClasses_ + target]) * sizes[b];
+      const int64_t pb = int64_t(counts[b * numClasses_ + target]) * sizes[a];
+      return pa < pb || (pa == pb && a < b);
+    });
+    std::fill(trueCounts.begin(), trueCounts.end(), 0);
+    for (size_t prefix = 1; prefix < order.size(); prefix++) {
+      for (int c = 0; c < numClasses_; c++)
+        trueCounts[c] += counts[order[prefix - 1] * numClasses_ + c];
+      const double gain = giniNode - splitGini(trueCounts, allCounts, falseCounts);
+      if (gain > best.gain) {
+        best.gain = gain;
+        best.question = Question(f, VecI(order.begin(), order.begin() + prefix), meta_);
+        best.trueCounts = trueCounts;
+      }
+    }
+  }
+  return best;
+}
+
+void HoeffdingTree::attemptSplit(int id) {
+  LeafStats& stats = leaves_[nodes_[id].leaf];
+  stats.lastCheck = stats.seen;
+  const bool pure = std::count_if(stats.seenCounts.begin(), stats.seenCounts.end(), [](int n) { return n > 0; }) <= 1;
+  if (pure)
+    return;
+
+  Candidate best, second;
+  for (int f = 0; f < numFeatures_; f++) {
+    Candidate candidate = numeric_[f] ? bestNumeric(stats, f) : bestCategorical(stats, f);
+    if (candidate.gain > best.gain) {
+      second.gain = best.gain;
+      best = std::move(candidate);
+    } else if (candidate.gain > second.gain) {
+      second.gain = candidate.gain;
+    }
+  }
+  // Not splitting, with a gain of 0, competes as well
+  const double runnerUp = std::max(second.gain, 0.0);
+  const double epsilon = std::sqrt(std::log(1.0 / params_.delta) / (2.0 * stats.seen));
+  if (best.gain <= 0 || (best.gain - runnerUp <= epsilon && epsilon >= params_.tieThreshold))
+    return;
+
+  // The children predict from the class counts of their side of the split
+  // until they have seen rows of their own
+  VecI falseCounts(numClasses_);
+  for (int c = 0; c < numClasses_; c++)
+    falseCounts[c] = stats.seenCounts[c] - best.trueCounts[c];
+  const int depth = nodes_[id].depth + 1;
+  // The statistics of the split leaf are replaced by those of a child
+  const int trueBranch = newLeaf(best.trueCounts, depth, nodes_[id].leaf);
+  const int falseBranch = newLeaf(falseCounts, depth);
+  OnlineNode& node = nodes_[id];
+  node.question = best.question;
+  node.trueBranch = trueBranch;
+  node.falseBranch = falseBranch;
+  node.leaf = -1;
+}
+
+int HoeffdingTree::predict(const VecI& row) const {
+  const VecI& counts = leaves_[nodes_[leafOf(row)].leaf].classCounts;
+  return std::max_element(counts.begin(), counts.end()) - counts.begin();
+}
+
+Tree HoeffdingTree::tree() const {
+  if (rowsSeen_ == 0)
+    throw std::runtime_error("No rows seen yet.");
+  Tree tree;
+  tree.setRoot(exportNode(tree, 0));
+  tree.computeProbabilities(OutputLayout::single(numClasses_));
+  return tree;
+}
+
+NodeId HoeffdingTree::exportNode(Tree& tree, int id) const {
+  const OnlineNode& node = nodes_[id];
+  if (node.leaf >= 0) {
+    ClassCounter counter;
+    const VecI& counts = leaves_[node.leaf].classCounts;
+    for (int c = 0; c < numClasses_; c++)
+      if (counts[c] > 0)
+        counter[c] = counts[c];
+    return tree.addLeaf(counter);
+  }
+  const NodeId trueBranch = exportNode(tree, node.trueBranch);
+  const NodeId falseBranch = exportNode(tree, node.falseBranch);
+  return tree.addNode(trueBranch, falseBranch, node.question);
+}
+
+void HoeffdingTree::print() const {
+  const Tree snapshot = tree();
+  DecisionTree::print(snapshot, meta_, snapshot.root());
+}
+
+void HoeffdingTree::test(const Data& testData) const {
+  TreeTest t(testData, meta_, tree());
+}
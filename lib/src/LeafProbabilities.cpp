@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <stdexcept>
+#include "LeafProbabilities.hpp"
+
+OutputLayout OutputLayout::single(int numClasses) {
+  return OutputLayout{{numClasses}, {}};
+}
+
+LeafProbabilities::LeafProbabilities(const OutputLayout& layout, double smoothing) :
+    layout_(layout), smoothing_(smoothing), offset_({0}), stride_(0), pool_() {
+  if (smoothing < 0)
+    throw std::runtime_error("Laplace smoothing must not be negative.");
+  for (const int classes: layout_.numClasses)
+    offset_.push_back(offset_.back() + classes);
+  stride_ = offset_.back();
+}
+
+void LeafProbabilities::add(const ClassCounter& counts) {
+  const size_t first = pool_.size();
+  pool_.resize(first + stride_, 0.0);
+  double* leaf = pool_.data() + first;
+  double total = 0;
+  for (const auto& [joint, count]: counts) {
+    for (size_t o = 0; o < layout_.numOutputs(); o++)
+      leaf[offset_[o] + layout_.classOf(joint, o)] += count;
+    total += count;
+  }
+  for (size_t o = 0; o < layout_.numOutputs(); o++) {
+    const double denominator = total + smoothing_ * layout_.numClasses[o];
+    for (Idx c = offset_[o]; c < offset_[o + 1]; c++)
+      leaf[c] = denominator > 0 ? (leaf[c] + smoothing_) / denominator : 0.0;
+  }
+}
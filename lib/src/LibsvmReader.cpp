@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <tuple>
+#include "LibsvmReader.hpp"
+
+namespace {
+
+const std::string kClassLabel = "class";
+
+const char* skipSpace(const char* p) {
+  while (*p == ' ' || *p == '\t' || *p == '\r')
+    p++;
+  return p;
+}
+
+}
+
+LibsvmReader::LibsvmReader(double scale) : scale_(scale) {}
+
+ColumnStore LibsvmReader::read(const std::string& filename) const {
+  MetaData meta;
+  SparseMatrix matrix;
+  VecI labels;
+  read(filename, meta, matrix, labels);
+  return ColumnStore(meta, std::move(matrix), std::move(labels));
+}
+
+ColumnStore LibsvmReader::read(const std::string& filename, const MetaData& reference) const {
+  MetaData meta = reference;
+  SparseMatrix matrix;
+  VecI labels;
+  read(filename, meta, matrix, labels);
+  return ColumnStore(meta, std::move(matrix), std::move(labels));
+}
+
+void LibsvmReader::read(const std::string& filename, MetaData& meta, SparseMatrix& matrix, VecI& labels) const {
+  std::ifstream file(filename);
+  if (!file)
+    throw std::runtime_error("Can't open file: " + filename);
+
+  const bool infer = meta.labels.empty();
+  const size_t limit = infer ? std::numeric_limits<Idx>::max() : meta.labels.size() - 1;
+  const std::string classLabel = infer ? kClassLabel : meta.labels.back();
+  MapSI& codes = meta.dMapSI[classLabel];
+  auto& names = meta.dMapIS[classLabel];
+  matrix = SparseMatrix();
+  labels.clear();
+
+  std::string line, label;
+  size_t lineNumber = 0, numFeatures = 0;
+  while (std::getline(file, line)) {
+    lineNumber++;
+    const char* p = skipSpace(line.c_str());
+    if (*p == '\0' || *p == '#')
+      continue;
+    const char* end = p;
+    while (*end && !std::isspace(static_cast<unsigned char>(*end)))
+      end++;
+    label.assign(p, end);
+    const auto code = codes.emplace(label, codes.size());
+    if (code.second)
+      names[code.first->second] = label;
+    labels.push_back(code.first->second);
+
+    const size_t rowBegin = matrix.feature.size();
+    bool sorted = true;
+    for (p = skipSpace(end); *p && *p != '#'; p = skipSpace(p)) {
+      char* next;
+      const unsigned long index = std::strtoul(p, &next, 10);
+      if (next == p || *next != ':') {
+        // qid:<n> and other named fields are skipped
+        while (*p && !std::isspace(static_cast<unsigned char>(*p)))
+          p++;
+        continue;
+      }
+      if (index == 0)
+        throw std::runtime_error("Feature indices start at 1, on line " + std::to_string(lineNumber) + " of " + filename);
+      p = next + 1;
+      const int value = std::strtod(p, &next) * scale_;
+      if (next == p)
+        throw std::runtime_error("Can't parse value on line " + std::to_string(lineNumber) + " of " + filename);
+      p = next;
+      if (value == 0 || index > limit)
+        continue;
+      if (matrix.feature.size() > rowBegin && matrix.feature.back() >= index - 1)
+        sorted = false;
+      matrix.feature.push_back(index - 1);
+      matrix.value.push_back(value);
+      numFeatures = std::max<size_t>(numFeatures, index);
+    }
+    if (!sorted) {
+      std::vector<std::pair<Idx, int>> entries;
+      for (size_t i = rowBegin; i < matrix.feature.size(); i++)
+        entries.emplace_back(matrix.feature[i], matrix.value[i]);
+      std::sort(entries.begin(), entries.end());
+      for (size_t i = rowBegin; i < matrix.feature.size(); i++)
+        std::tie(matrix.feature[i], matrix.value[i]) = entries[i - rowBegin];
+    }
+    matrix.rowStart.push_back(matrix.feature.size());
+  }
+
+  if (infer) {
+    const MapSI classCodes = std::move(codes);
+    const MapIS classNames = std::move(names);
+    meta = MetaData();
+    for (size_t f = 1; f <= numFeatures; f++) {
+      meta.labels.push_back("f" + std::to_string(f));
+      meta.types.push_back("NUMERIC");
+    }
+    meta.labels.push_back(kClassLabel);
+    meta.types.push_back("CATEGORICAL");
+    meta.dMapSI[kClassLabel] = classCodes;
+    meta.dMapIS[kClassLabel] = classNames;
+  }
+}
@@ -6,14 +6,12 @@
 
 #include "Node.hpp"
 
-using std::make_shared;
+Node::Node() : trueBranch_(kNoNode), falseBranch_(kNoNode), question_({}), leaf_(kNoNode) {}
 
-Node::Node() : trueBranch_(nullptr), falseBranch_(nullptr), question_({}), leaf_(nullptr) {}
+Node::Node(Idx leaf) : trueBranch_(kNoNode), falseBranch_(kNoNode), question_({}), leaf_(leaf) {}
 
-Node::Node(Leaf l) : trueBranch_(nullptr), falseBranch_(nullptr), question_({}), leaf_(make_shared<Leaf>(l)) {}
-
-Node::Node(const Node &trueBranch, const Node &falseBranch, const Question &question) :
-    trueBranch_(make_shared<Node>(trueBranch)),
-    falseBranch_(make_shared<Node>(falseBranch)),
+Node::Node(NodeId trueBranch, NodeId falseBranch, const Question &question) :
+    trueBranch_(trueBranch),
+    falseBranch_(falseBranch),
     question_(question),
-    leaf_(nullptr) {}
+    leaf_(kNoNode) {}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cstdlib>
+#include <thread>
+#include "Numa.hpp"
+
+#ifdef DECISIONTREE_NUMA
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+namespace {
+
+int hardwareNodes() {
+#ifdef DECISIONTREE_NUMA
+  if (Numa::available())
+    return std::max(1, numa_num_configured_nodes());
+#endif
+  return 1;
+}
+
+}
+
+bool Numa::available() {
+#ifdef DECISIONTREE_NUMA
+  static const bool available = numa_available() >= 0;
+  return available;
+#else
+  return false;
+#endif
+}
+
+int Numa::numNodes() {
+  static const int nodes = []() {
+    const char* forced = std::getenv("DECISIONTREE_NUMA_NODES");
+    if (forced && std::atoi(forced) > 0)
+      return std::atoi(forced);
+    return hardwareNodes();
+  }();
+  return nodes;
+}
+
+size_t Numa::numCpus(int node) {
+#ifdef DECISIONTREE_NUMA
+  if (available() && numNodes() == hardwareNodes()) {
+    struct bitmask* cpus = numa_allocate_cpumask();
+    size_t count = 0;
+    if (numa_node_to_cpus(node, cpus) == 0)
+      count = numa_bitmask_weight(cpus);
+    numa_free_cpumask(cpus);
+    if (count > 0)
+      return count;
+  }
+#endif
+  return std::max<size_t>(1, std::thread::hardware_concurrency() / numNodes());
+}
+
+void Numa::bindThread(int node) {
+#ifdef DECISIONTREE_NUMA
+  if (available()) {
+    numa_run_on_node(node % hardwareNodes());
+    numa_set_localalloc();
+  }
+#else
+  (void) node;
+#endif
+}
+
+int Numa::nodeOfAddress(const void* address) {
+#ifdef DECISIONTREE_NUMA
+  int node = -1;
+  if (available() && get_mempolicy(&node, nullptr, 0, const_cast<void*>(address), MPOL_F_NODE | MPOL_F_ADDR) == 0)
+    return node;
+#else
+  (void) address;
+#endif
+  return -1;
+}
+
+NumaPools::NumaPools() : numNodes_(Numa::numNodes()), pools_() {
+  // A single node uses the shared pool, so that no threads are duplicated
+  if (numNodes_ > 1)
+    for (int node = 0; node < numNodes_; node++)
+      pools_.push_back(std::make_unique<ThreadPool>(Numa::numCpus(node), node));
+}
+
+ThreadPool& NumaPools::pool(int node) {
+  return pools_.empty() ? ThreadPool::shared() : *pools_[node];
+}
+
+NumaPools& NumaPools::shared() {
+  static NumaPools pools;
+  return pools;
+}
@@ -0,0 +1,293 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <array>
+#include <cmath>
+#include "Predictor.hpp"
+#include "Arena.hpp"
+#include "Bagging.hpp"
+#include "DecisionTree.hpp"
+
+namespace {
+
+// Classes whose votes are tallied on the stack by early-exit prediction
+constexpr size_t kMaxTallyClasses = 64;
+
+int argmax(const double* values, size_t n) {
+  return std::max_element(values, values + n) - values;
+}
+
+// Row of a column store, read one attribute at a time
+struct StoreRow {
+  const ColumnStore& store;
+  Idx r;
+  inline int operator[](int f) const { return store.value(f, r); }
+};
+
+}
+
+double Predictions::accuracy(const Data& data) const {
+  double correct = 0;
+  for (size_t i = 0; i < data.size(); i++)
+    if (labels[i] == *std::rbegin(data[i]))
+      correct += 1;
+  return correct / data.size();
+}
+
+Predictor::Predictor(const DecisionTree& tree) :
+    Predictor(std::vector<const Tree*>{&tree.tree()}, tree.numClasses(), Voting::Average) {}
+
+Predictor::Predictor(const Bagging& bagging, Voting voting) :
+    Predictor(bagging.trees(), bagging.learners().front().numClasses(), voting) {}
+
+Predictor::Predictor(const std::vector<const Tree*>& trees, int numClasses, Voting voting) :
+    numClasses_(numClasses),
+    voting_(voting),
+    nodes_(),
+    roots_(),
+    categoryWords_(),
+    outputOffset_({0}),
+    leafProbabilities_(),
+    leafLabels_() {
+  // Trees without a probability pool have a single output
+  if (!trees.empty() && !trees.front()->probabilities().empty()) {
+    for (const int classes: trees.front()->probabilities().layout().numClasses)
+      outputOffset_.push_back(outputOffset_.back() + classes);
+    numClasses_ = outputOffset_[1];
+  } else {
+    outputOffset_.push_back(numClasses_);
+  }
+  for (const Tree* tree: trees)
+    roots_.push_back(flatten(*tree, tree->root()));
+}
+
+uint32_t Predictor::flatten(const Tree& tree, NodeId id) {
+  const Node& node = tree.node(id);
+  const uint32_t index = nodes_.size();
+  nodes_.push_back({-1, 0, 0, 0, 0, 0});
+  if (node.isLeaf()) {
+    const size_t offset = leafProbabilities_.size();
+    leafProbabilities_.resize(offset + outputOffset_.back(), 0.0);
+    if (tree.probabilities().empty()) {
+      const ClassCounter counts = tree.leaf(node).predictions();
+      const double total = Utils::tree::mapValueSum(counts);
+      for (const auto& [label, count]: counts)
+        leafProbabilities_[offset + label] = count / total;
+    } else {
+      if (tree.probabilities().numOutputs() != numOutputs())
+        throw std::runtime_error("Trees predict different outputs.");
+      for (size_t o = 0; o < numOutputs(); o++) {
+        const ProbabilityView probabilities = tree.probabilities(node, o);
+        if (probabilities.size() != outputOffset_[o + 1] - outputOffset_[o])
+          throw std::runtime_error("Trees predict different outputs.");
+        std::copy(probabilities.begin(), probabilities.end(), leafProbabilities_.begin() + offset + outputOffset_[o]);
+      }
+    }
+    nodes_[index].trueBranch = leafLabels_.size();
+    leafLabels_.push_back(argmax(leafProbabilities_.data() + offset, numClasses_));
+    return index;
+  }
+  const Question& question = node.question();
+  FlatNode flat = {question.column_, question.value_, 0, 0, 0, 0};
+  if (!question.isNumeric()) {
+    flat.categories = categoryWords_.size();
+    flat.numWords = question.categories().size();
+    categoryWords_.insert(categoryWords_.end(), question.categories().begin(), question.categories().end());
+  }
+  flat.trueBranch = flatten(tree, node.trueBranch());
+  flat.falseBranch = flatten(tree, node.falseBranch());
+  nodes_[index] = flat;
+  return index;
+}
+
+template <typename Row>
+inline uint32_t Predictor::leafOf(uint32_t id, const Row& row) const {
+  const FlatNode* node = &nodes_[id];
+  while (node->column >= 0) {
+    const int value = row[node->column];
+    bool goTrue;
+    if (node->numWords == 0) {
+      goTrue = value >= node->threshold;
+    } else {
+      const uint32_t word = static_cast<uint32_t>(value) >> 6;
+      goTrue = word < node->numWords && (categoryWords_[node->categories + word] >> (value & 63)) & 1;
+    }
+    node = &nodes_[goTrue ? node->trueBranch : node->falseBranch];
+  }
+  return node->trueBranch;
+}
+
+void Predictor::score(const Data& rows, size_t rowBegin, size_t rowEnd, size_t treeBegin, size_t treeEnd, double* out) const {
+  // Tree-major order keeps the nodes of one tree in cache while it is
+  // applied to the whole block of rows
+  for (size_t t = treeBegin; t < treeEnd; t++) {
+    double* rowOut = out;
+    for (size_t r = rowBegin; r < rowEnd; r++, rowOut += numClasses_) {
+      vote(leafOf(roots_[t], rows[r]), rowOut);
+    }
+  }
+}
+
+inline void Predictor::vote(uint32_t leaf, double* out) const {
+  if (voting_ == Voting::Majority) {
+    out[leafLabels_[leaf]] += 1.0;
+  } else {
+    const double* probabilities = leafProbabilities_.data() + leaf * outputOffset_.back();
+    for (size_t c = 0; c < numClasses_; c++)
+      out[c] += probabilities[c];
+  }
+}
+
+void Predictor::predictProba(const VecI& row, double* probabilities) const {
+  std::fill(probabilities, probabilities + numClasses_, 0.0);
+  for (const uint32_t root: roots_)
+    vote(leafOf(root, row), probabilities);
+  for (size_t c = 0; c < numClasses_; c++)
+    probabilities[c] /= roots_.size();
+}
+
+int Predictor::predict(const VecI& row) const {
+  ScratchBuffer<double> probabilities(numClasses_);
+  predictProba(row, probabilities->data());
+  return argmax(probabilities->data(), numClasses_);
+}
+
+void Predictor::predictProba(const ColumnStore& store, Idx r, double* probabilities) const {
+  const StoreRow row{store, r};
+  std::fill(probabilities, probabilities + numClasses_, 0.0);
+  for (const uint32_t root: roots_)
+    vote(leafOf(root, row), probabilities);
+  for (size_t c = 0; c < numClasses_; c++)
+    probabilities[c] /= roots_.size();
+}
+
+int Predictor::predict(const ColumnStore& store, Idx r) const {
+  ScratchBuffer<double> probabilities(numClasses_);
+  predictProba(store, r, probabilities->data());
+  return argmax(probabilities->data(), numClasses_);
+}
+
+int Predictor::predict(const VecI& row, const EarlyExit& rule, size_t* treesUsed) const {
+  std::array<double, kMaxTallyClasses> stackTally;
+  ScratchBuffer<double> heapTally;
+  double* tally = stackTally.data();
+  if (numClasses_ > kMaxTallyClasses) {
+    heapTally->assign(numClasses_, 0.0);
+    tally = heapTally->data();
+  }
+  std::fill(tally, tally + numClasses_, 0.0);
+
+  // Squared lead needed per evaluated tree for the confidence bound: the
+  // contribution of a tree to the lead lies in [-1, 1]
+  const double bound = rule.confidence < 1.0 ? 2.0 * std::log(1.0 / (1.0 - rule.confidence)) : 0.0;
+  const size_t T = roots_.size();
+  size_t t = 0;
+  while (t < T) {
+    vote(leafOf(roots_[t++], row), tally);
+    if (t < rule.minTrees || t == T)
+      continue;
+    const int leader = argmax(tally, numClasses_);
+    // Every remaining tree adds at most 1 to any class. Ties go to the
+    // lowest class, as in argmax.
+    const double remaining = T - t;
+    bool settled = true;
+    double runnerUp = 0.0;
+    for (size_t c = 0; c < numClasses_; c++) {
+      if ((int) c == leader)
+        continue;
+      runnerUp = std::max(runnerUp, tally[c]);
+      const double reach = tally[c] + remaining;
+      if (reach > tally[leader] || (reach == tally[leader] && (int) c < leader))
+        settled = false;
+    }
+    const double lead = tally[leader] - runnerUp;
+    if (settled || (bound > 0 && lead > 0 && lead * lead >= bound * t))
+      break;
+  }
+  if (treesUsed)
+    *treesUsed = t;
+  return argmax(tally, numClasses_);
+}
+
+ProbabilityView Predictor::leafProbabilities(const VecI& row, size_t t, size_t output) const {
+  const double* first = leafProbabilities_.data() + leafOf(roots_[t], row) * outputOffset_.back() + outputOffset_[output];
+  return ProbabilityView{first, first + (outputOffset_[output + 1] - outputOffset_[output])};
+}
+
+Predictor Predictor::reordered(const VecIdx& order) const {
+  Predictor predictor(*this);
+  std::vector<bool> seen(roots_.size(), false);
+  if (order.size() != roots_.size())
+    throw std::runtime_error("Order does not list every tree once.");
+  for (size_t i = 0; i < order.size(); i++) {
+    if (order[i] >= roots_.size() || seen[order[i]])
+      throw std::runtime_error("Order does not list every tree once.");
+    seen[order[i]] = true;
+    predictor.roots_[i] = roots_[order[i]];
+  }
+  return predictor;
+}
+
+VecIdx Predictor::rankTrees(const Data& data) const {
+  std::vector<size_t> correct(roots_.size(), 0);
+  for (size_t t = 0; t < roots_.size(); t++)
+    for (const auto& row: data)
+      correct[t] += leafLabels_[leafOf(roots_[t], row)] == *std::rbegin(row);
+  VecIdx order(roots_.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](Idx a, Idx b) {
+    return correct[a] > correct[b];
+  });
+  return order;
+}
+
+Predictions Predictor::predict(const Data& rows) const {
+  return predict(rows, ThreadPool::shared());
+}
+
+Predictions Predictor::predict(const Data& rows, ThreadPool& pool) const {
+  const size_t N = rows.size(), T = roots_.size(), C = numClasses_;
+  Predictions predictions;
+  predictions.numClasses = C;
+  predictions.probabilities.assign(N * C, 0.0);
+  predictions.labels.resize(N);
+
+  if (N * T < kParallelWork) {
+    score(rows, 0, N, 0, T, predictions.probabilities.data());
+  } else {
+    // Split over trees as well when there are too few row blocks to keep
+    // the pool busy; each extra tree group accumulates in its own buffer
+    const size_t rowBlocks = (N + kRowBlock - 1) / kRowBlock;
+    const size_t wanted = 2 * std::max<size_t>(pool.size(), 1);
+    const size_t treeGroups = rowBlocks >= wanted ? 1 : std::min(T, (wanted + rowBlocks - 1) / rowBlocks);
+    std::vector<double> partial((treeGroups - 1) * N * C, 0.0);
+    pool.parallelFor(rowBlocks * treeGroups, [&](size_t task) {
+      const size_t block = task % rowBlocks, group = task / rowBlocks;
+      const size_t rowBegin = block * kRowBlock, rowEnd = std::min(N, rowBegin + kRowBlock);
+      double* out = group == 0 ? predictions.probabilities.data() : partial.data() + (group - 1) * N * C;
+      score(rows, rowBegin, rowEnd, group * T / treeGroups, (group + 1) * T / treeGroups, out + rowBegin * C);
+    });
+    for (size_t g = 0; g + 1 < treeGroups; g++)
+      for (size_t i = 0; i < N * C; i++)
+        predictions.probabilities[i] += partial[g * N * C + i];
+  }
+
+  for (size_t r = 0; r < N; r++) {
+    double* probabilities = predictions.probabilities.data() + r * C;
+    for (size_t c = 0; c < C; c++)
+      probabilities[c] /= T;
+    predictions.labels[r] = argmax(probabilities, C);
+  }
+  return predictions;
+}
+
+size_t Predictor::bytes() const {
+  return nodes_.size() * sizeof(FlatNode)
+    + roots_.size() * sizeof(uint32_t)
+    + categoryWords_.size() * sizeof(uint64_t)
+    + leafProbabilities_.size() * sizeof(double)
+    + leafLabels_.size() * sizeof(int);
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cmath>
+#include <stdexcept>
+#include "Arena.hpp"
+#include "QuantileSketch.hpp"
+
+QuantileSketch::QuantileSketch(double epsilon) :
+    epsilon_(epsilon), budget_(), entries_() {
+  if (!(epsilon > 0 && epsilon < 1))
+    throw std::runtime_error("Sketch error must lie in (0, 1).");
+  budget_ = std::max<size_t>(3, std::ceil(6 / epsilon));
+}
+
+QuantileSketch::QuantileSketch(const int* first, const int* last, double epsilon) :
+    QuantileSketch(epsilon) {
+  ScratchBuffer<int> sorted;
+  sorted->assign(first, last);
+  std::sort(sorted->begin(), sorted->end());
+  uint64_t below = 0;
+  for (auto it = sorted->begin(); it != sorted->end(); ) {
+    const auto next = std::upper_bound(it, sorted->end(), *it);
+    const uint64_t weight = next - it;
+    entries_.push_back({*it, below, below + weight, weight});
+    below += weight;
+    it = next;
+  }
+  prune();
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+  if (other.entries_.empty())
+    return;
+  if (entries_.empty()) {
+    entries_ = other.entries_;
+    return;
+  }
+  // An entry of one side lies after the last entry of the other side that is
+  // below it and before the first one that is above it
+  std::vector<Entry> merged;
+  merged.reserve(entries_.size() + other.entries_.size());
+  auto a = entries_.begin(), aEnd = entries_.end();
+  auto b = other.entries_.begin(), bEnd = other.entries_.end();
+  uint64_t aPrevRmin = 0, bPrevRmin = 0;
+  while (a != aEnd && b != bEnd) {
+    if (a->value == b->value) {
+      merged.push_back({a->value, a->rmin + b->rmin, a->rmax + b->rmax, a->weight + b->weight});
+      aPrevRmin = a->rminNext();
+      bPrevRmin = b->rminNext();
+      ++a; ++b;
+    } else if (a->value < b->value) {
+      merged.push_back({a->value, a->rmin + bPrevRmin, a->rmax + b->rmaxPrev(), a->weight});
+      aPrevRmin = a->rminNext();
+      ++a;
+    } else {
+      merged.push_back({b->value, b->rmin + aPrevRmin, b->rmax + a->rmaxPrev(), b->weight});
+      bPrevRmin = b->rminNext();
+      ++b;
+    }
+  }
+  const uint64_t aTotal = entries_.back().rmax, bTotal = other.entries_.back().rmax;
+  for (; a != aEnd; ++a)
+    merged.push_back({a->value, a->rmin + bPrevRmin, a->rmax + bTotal, a->weight});
+  for (; b != bEnd; ++b)
+    merged.push_back({b->value, b->rmin + aPrevRmin, b->rmax + aTotal, b->weight});
+  entries_ = std::move(merged);
+  prune();
+}
+
+void QuantileSketch::prune() {
+  if (entries_.size() <= budget_)
+    return;
+  // Keeps the first and last entry and, in between, the entries whose ranks
+  // lie closest to budget - 1 evenly spaced ranks
+  const std::vector<Entry>& src = entries_;
+  std::vector<Entry> kept;
+  kept.reserve(budget_);
+  kept.push_back(src.front());
+  const double begin = src.front().rmax;
+  const double range = src.back().rmin - begin;
+  const size_t n = budget_ - 1;
+  size_t i = 1, last = 0;
+  for (size_t k = 1; k < n; k++) {
+    const double target = 2 * (k * range / n + begin);
+    while (i < src.size() - 1 && target >= src[i + 1].rmax + src[i + 1].rmin)
+      i++;
+    if (i == src.size() - 1)
+      break;
+    const size_t pick = target < src[i].rminNext() + src[i + 1].rmaxPrev() ? i : i + 1;
+    if (pick != last) {
+      kept.push_back(src[pick]);
+      last = pick;
+    }
+  }
+  if (last != src.size() - 1)
+    kept.push_back(src.back());
+  entries_ = std::move(kept);
+}
+
+double QuantileSketch::gap() const {
+  uint64_t widest = 0;
+  for (size_t i = 1; i < entries_.size(); i++)
+    widest = std::max(widest, entries_[i].rmaxPrev() - std::min(entries_[i].rmaxPrev(), entries_[i - 1].rminNext()));
+  return count() ? (double) widest / count() : 0.0;
+}
+
+int QuantileSketch::quantile(double q) const {
+  if (entries_.empty())
+    throw std::runtime_error("Quantile of an empty sketch.");
+  const double rank = q * count();
+  auto best = entries_.begin();
+  for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+    if (std::abs((it->rmin + it->rmax) / 2.0 - rank) < std::abs((best->rmin + best->rmax) / 2.0 - rank))
+      best = it;
+  }
+  return best->value;
+}
+
+VecI QuantileSketch::values() const {
+  VecI values;
+  values.reserve(entries_.size());
+  for (const auto& entry: entries_)
+    values.push_back(entry.value);
+  return values;
+}
@@ -4,30 +4,48 @@
  * Written by Pieter Robberechts, 2019
  */
 
+#include <boost/algorithm/string/join.hpp>
 #include "Question.hpp"
 #include "Utils.hpp"
 
 using std::string;
 using std::vector;
 
-Question::Question(): column_(0), value_(0), isNumeric_(true){}
-Question::Question(const int column, const int value, const MetaData& meta) : column_(column), value_(value), isNumeric_(meta.types[column_]=="NUMERIC")
- {}
+Question::Question(): column_(0), value_(0), isNumeric_(true), categories_(){}
+Question::Question(const int column, const int value, const MetaData& meta) :
+    Question(column, VecI{value}, meta) {}
 
-const bool Question::solve(VecI example) const {
-  const int& val = example[column_];
-  if (isNumeric()) {
-    return val >= value_;
-  } else {
-    return val == value_;
+Question::Question(const int column, const VecI& categories, const MetaData& meta) :
+    column_(column),
+    value_(categories.empty() ? 0 : *std::min_element(categories.begin(), categories.end())),
+    isNumeric_(meta.types[column_]=="NUMERIC"),
+    categories_() {
+  if (isNumeric_)
+    return;
+  for (const int category: categories) {
+    const size_t word = static_cast<size_t>(category) >> 6;
+    if (word >= categories_.size())
+      categories_.resize(word + 1, 0);
+    categories_[word] |= uint64_t(1) << (category & 63);
   }
 }
+
+const bool Question::solve(const VecI& example) const {
+  return matches(example[column_]);
+}
+
 const string Question::toString(const MetaData& meta) const {
   string condition = ">=";
   string val = std::to_string(value_);
   if (!isNumeric()){
-    condition = "==";
-    val = meta.dMapIS.at(meta.labels[column_]).at(value_);
+    const MapIS& names = meta.dMapIS.at(meta.labels[column_]);
+    VecS members;
+    for (size_t word = 0; word < categories_.size(); word++)
+      for (int bit = 0; bit < 64; bit++)
+        if ((categories_[word] >> bit) & 1)
+          members.push_back(names.at(word * 64 + bit));
+    condition = members.size() == 1 ? "==" : "in";
+    val = members.size() == 1 ? members.front() : "{" + boost::algorithm::join(members, ", ") + "}";
   }
   return "Is " + meta.labels[column_] + " " + condition + " " + val + "?";
 }
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cstdlib>
+#include <cstring>
+#include <strings.h>
+#include <boost/algorithm/string.hpp>
+#include "RowStream.hpp"
+
+namespace {
+
+const char* kWhiteSpace = " \t\r\n";
+
+std::string trimmed(const std::string& s) {
+  return boost::algorithm::trim_copy_if(s, boost::is_any_of(kWhiteSpace));
+}
+
+bool startsWith(const std::string& s, const char* prefix) {
+  return strncasecmp(s.c_str(), prefix, strlen(prefix)) == 0;
+}
+
+}
+
+RowStream::RowStream(const std::string& filename, const MetaData& meta) :
+    file_(filename), meta_(meta), target_(), line_(), lineNumber_(0) {
+  if (!file_)
+    throw std::runtime_error("Can't open file: " + filename);
+  readHeader();
+}
+
+void RowStream::readHeader() {
+  VecS names;
+  bool arff = false;
+  while (std::getline(file_, line_)) {
+    lineNumber_++;
+    const std::string s = trimmed(line_);
+    if (s.empty() || s[0] == '%')
+      continue;
+    if (startsWith(s, "@RELATION")) {
+      arff = true;
+    } else if (startsWith(s, "@ATTRIBUTE")) {
+      arff = true;
+      // Name up to the type or the list of nominal values
+      std::string rest = trimmed(s.substr(std::string("@ATTRIBUTE").size()));
+      const size_t brace = rest.find('{');
+      rest = brace != std::string::npos ? rest.substr(0, brace) : rest.substr(0, rest.find_last_of(kWhiteSpace));
+      names.push_back(trimmed(rest));
+    } else if (startsWith(s, "@DATA")) {
+      break;
+    } else if (!arff) {
+      // CSV header line
+      boost::split(names, s, boost::is_any_of(","));
+      for (auto& name: names)
+        name = trimmed(name);
+      break;
+    }
+  }
+
+  for (const auto& name: names) {
+    int column = -1;
+    for (size_t l = 0; l < meta_.labels.size(); l++)
+      if (trimmed(meta_.labels[l]) == name)
+        column = l;
+    target_.push_back(column);
+  }
+  // Every attribute is needed, the class is optional and other columns are skipped
+  for (int column = 0; column + 1 < (int) meta_.labels.size(); column++)
+    if (std::find(target_.begin(), target_.end(), column) == target_.end())
+      throw std::runtime_error("Column '" + trimmed(meta_.labels[column]) + "' is missing from the input.");
+}
+
+size_t RowStream::next(Data& chunk, size_t maxRows) {
+  size_t n = 0;
+  if (chunk.size() < maxRows)
+    chunk.resize(maxRows);
+  while (n < maxRows && std::getline(file_, line_)) {
+    lineNumber_++;
+    if (line_.find_first_not_of(kWhiteSpace) == std::string::npos || line_[line_.find_first_not_of(kWhiteSpace)] == '%')
+      continue;
+    parseLine(line_, chunk[n++]);
+  }
+  chunk.resize(n);
+  return n;
+}
+
+void RowStream::parseLine(const std::string& line, VecI& row) const {
+  thread_local std::string value;
+  row.assign(meta_.labels.size(), -1);
+  size_t begin = 0;
+  for (size_t field = 0; field < target_.size(); field++) {
+    size_t end = line.find(',', begin);
+    if (end == std::string::npos)
+      end = line.size();
+    const int column = target_[field];
+    if (column >= 0) {
+      const size_t first = line.find_first_not_of(kWhiteSpace, begin);
+      size_t last = line.find_last_not_of(kWhiteSpace, end - 1);
+      if (first >= end || last == std::string::npos || last < first)
+        throw std::runtime_error("Missing value on line " + std::to_string(lineNumber_));
+      value.assign(line, first, last - first + 1);
+      if (meta_.types[column] == "NUMERIC") {
+        char* parsed;
+        row[column] = std::strtod(value.c_str(), &parsed);
+        if (parsed == value.c_str())
+          throw std::runtime_error("Can't parse '" + value + "' on line " + std::to_string(lineNumber_));
+      } else {
+        const auto codes = meta_.dMapSI.find(meta_.labels[column]);
+        if (codes != std::end(meta_.dMapSI)) {
+          const auto code = codes->second.find(value);
+          row[column] = code != std::end(codes->second) ? code->second : -1;
+        }
+      }
+    }
+    if (end == line.size() && field + 1 < target_.size())
+      throw std::runtime_error("Too few values on line " + std::to_string(lineNumber_));
+    begin = end + 1;
+  }
+}
@@ -0,0 +1,347 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <unordered_map>
+#include "ScoringServer.hpp"
+
+namespace {
+
+constexpr uint64_t kListener = 0;
+constexpr uint64_t kWakeup = 1;
+// Lines longer than this are not rows; the connection is dropped
+constexpr size_t kMaxLine = 1 << 20;
+
+int64_t now() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Connection {
+  int fd = -1;
+  std::string input = {};
+  std::string output = {};
+  uint64_t nextSeq = 0;  // of the next request read
+  uint64_t nextSent = 0; // of the next response written
+  std::map<uint64_t, std::string> ready = {}; // responses waiting for earlier ones
+  bool readClosed = false;
+  bool broken = false;
+  uint32_t events = EPOLLIN; // registered with epoll
+};
+
+// Attribute codes separated by commas; false when a field is not an integer
+bool parseRow(const char* first, const char* last, VecI& row) {
+  row.clear();
+  while (true) {
+    const char* comma = static_cast<const char*>(std::memchr(first, ',', last - first));
+    const char* end = comma == nullptr ? last : comma;
+    char* parsed = nullptr;
+    const long value = std::strtol(first, &parsed, 10);
+    if (parsed == first || parsed > end)
+      return false;
+    while (parsed < end && (*parsed == ' ' || *parsed == '\t' || *parsed == '\r'))
+      ++parsed;
+    if (parsed != end)
+      return false;
+    row.push_back(value);
+    if (comma == nullptr)
+      return true;
+    first = comma + 1;
+  }
+}
+
+}
+
+ScoringServer::ScoringServer(const std::string& socketPath, size_t numFeatures, std::unique_ptr<const Predictor> model,
+                             const ScoringOptions& options) :
+    socketPath_(socketPath),
+    numFeatures_(numFeatures),
+    options_(options),
+    model_(std::max<size_t>(options.scorers, 1), std::move(model)),
+    pending_(options.queueCapacity),
+    // Room for every queued request and every batch in flight, so that the
+    // scorers never wait on the socket thread
+    done_(options.queueCapacity + std::max<size_t>(options.scorers, 1) * options.maxBatch),
+    stopping_(false),
+    requests_(0),
+    batches_(0),
+    listener_(-1),
+    wakeup_(-1),
+    scorers_() {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  if (socketPath.size() >= sizeof(address.sun_path))
+    throw std::runtime_error("Socket path too long: " + socketPath);
+  address.sun_family = AF_UNIX;
+  std::strcpy(address.sun_path, socketPath.c_str());
+  listener_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0);
+  unlink(socketPath.c_str());
+  if (listener_ < 0 || bind(listener_, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+      || listen(listener_, 128) != 0) {
+    const std::string reason = std::strerror(errno);
+    if (listener_ >= 0)
+      close(listener_);
+    throw std::runtime_error("Can't listen on " + socketPath + ": " + reason);
+  }
+  wakeup_ = eventfd(0, EFD_NONBLOCK);
+  if (wakeup_ < 0) {
+    close(listener_);
+    throw std::runtime_error("Can't create eventfd: " + std::string(std::strerror(errno)));
+  }
+}
+
+ScoringServer::~ScoringServer() {
+  stop();
+  for (auto& scorer: scorers_)
+    if (scorer.joinable())
+      scorer.join();
+  close(listener_);
+  close(wakeup_);
+  unlink(socketPath_.c_str());
+}
+
+void ScoringServer::stop() {
+  stopping_ = true;
+  const uint64_t one = 1;
+  if (write(wakeup_, &one, sizeof(one)) < 0) {
+    // The counter is saturated, so the socket thread is woken already
+  }
+}
+
+void ScoringServer::publish(std::unique_ptr<const Predictor> model) {
+  model_.publish(std::move(model));
+}
+
+void ScoringServer::run() {
+  for (size_t s = 0; s < std::max<size_t>(options_.scorers, 1); s++)
+    scorers_.emplace_back(&ScoringServer::score, this, s);
+
+  const int poller = epoll_create1(0);
+  if (poller < 0)
+    throw std::runtime_error("Can't create epoll instance: " + std::string(std::strerror(errno)));
+  auto watch = [poller](int op, int fd, uint64_t id, uint32_t events) {
+    epoll_event event;
+    event.events = events;
+    event.data.u64 = id;
+    epoll_ctl(poller, op, fd, &event);
+  };
+  watch(EPOLL_CTL_ADD, listener_, kListener, EPOLLIN);
+  watch(EPOLL_CTL_ADD, wakeup_, kWakeup, EPOLLIN);
+
+  std::unordered_map<uint64_t, Connection> connections;
+  uint64_t nextId = kWakeup + 1;
+
+  // Writes the responses that are next in line, as far as the socket takes them
+  auto flush = [&](uint64_t id, Connection& c) {
+    for (auto it = c.ready.begin(); it != c.ready.end() && it->first == c.nextSent; it = c.ready.erase(it)) {
+      c.output += it->second;
+      c.output += '\n';
+      c.nextSent++;
+    }
+    size_t written = 0;
+    while (written < c.output.size()) {
+      const ssize_t n = send(c.fd, c.output.data() + written, c.output.size() - written, MSG_NOSIGNAL);
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        break;
+      if (n <= 0) {
+        c.broken = true;
+        return;
+      }
+      written += n;
+    }
+    c.output.erase(0, written);
+    // Once the client closed its end, EPOLLIN would report the end of input
+    // on every wait, so only pending output is watched
+    const uint32_t events = (c.readClosed ? 0 : EPOLLIN) | (c.output.empty() ? 0 : EPOLLOUT);
+    if (c.events != events) {
+      c.events = events;
+      watch(EPOLL_CTL_MOD, c.fd, id, events);
+    }
+  };
+
+  auto receive = [&](uint64_t id, Connection& c) {
+    char buffer[1 << 16];
+    while (true) {
+      const ssize_t n = read(c.fd, buffer, sizeof(buffer));
+      if (n < 0 && errno == EINTR)
+        continue;
+      if (n < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        break;
+      if (n <= 0) {
+        c.broken = n < 0;
+        c.readClosed = true;
+        break;
+      }
+      c.input.append(buffer, n);
+    }
+
+    size_t begin = 0;
+    for (size_t end; (end = c.input.find('\n', begin)) != std::string::npos; begin = end + 1) {
+      const char* first = c.input.data() + begin;
+      const char* last = c.input.data() + end;
+      while (last > first && (last[-1] == '\r' || last[-1] == ' '))
+        --last;
+      if (first == last)
+        continue;
+      const uint64_t seq = c.nextSeq++;
+      Request request;
+      if (!parseRow(first, last, request.row)) {
+        c.ready[seq] = "error: invalid row";
+        continue;
+      }
+      if (request.row.size() != numFeatures_ && request.row.size() != numFeatures_ + 1) {
+        c.ready[seq] = "error: expected " + std::to_string(numFeatures_) + " values";
+        continue;
+      }
+      request.connection = id;
+      request.seq = seq;
+      request.arrival = now();
+      if (!pending_.tryPush(request))
+        c.ready[seq] = "error: busy";
+    }
+    c.input.erase(0, begin);
+    if (c.input.size() > kMaxLine)
+      c.broken = true;
+    flush(id, c);
+  };
+
+  // Connections are closed once every request read got its response
+  auto settle = [&](std::unordered_map<uint64_t, Connection>::iterator it) {
+    const Connection& c = it->second;
+    if (c.broken || (c.readClosed && c.nextSent == c.nextSeq && c.output.empty())) {
+      close(c.fd);
+      connections.erase(it);
+    }
+  };
+
+  epoll_event events[64];
+  while (!stopping_) {
+    const int n = epoll_wait(poller, events, 64, -1);
+    if (n < 0 && errno == EINTR)
+      continue;
+    if (n < 0)
+      break;
+    for (int e = 0; e < n; e++) {
+      const uint64_t id = events[e].data.u64;
+      if (id == kListener) {
+        for (int fd; (fd = accept4(listener_, nullptr, nullptr, SOCK_NONBLOCK)) >= 0; ) {
+          Connection& c = connections[nextId];
+          c.fd = fd;
+          watch(EPOLL_CTL_ADD, fd, nextId++, EPOLLIN);
+        }
+        continue;
+      }
+      if (id == kWakeup) {
+        uint64_t count;
+        if (read(wakeup_, &count, sizeof(count)) < 0) {
+          // Nothing to drain
+        }
+        Response response;
+        while (done_.tryPop(response)) {
+          const auto found = connections.find(response.connection);
+          if (found == connections.end())
+            continue; // the client went away
+          found->second.ready[response.seq] = std::move(response.text);
+          flush(found->first, found->second);
+          settle(found);
+        }
+      } else {
+        const auto found = connections.find(id);
+        if (found == connections.end())
+          continue;
+        if (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+          receive(id, found->second);
+        // These are reported whatever is watched; the client can't read its
+        // responses anymore
+        if (events[e].events & (EPOLLHUP | EPOLLERR))
+          found->second.broken = true;
+        if (events[e].events & EPOLLOUT)
+          flush(id, found->second);
+        settle(found);
+      }
+    }
+  }
+
+  stopping_ = true;
+  for (auto& scorer: scorers_)
+    scorer.join();
+  scorers_.clear();
+  for (auto& [id, c]: connections)
+    close(c.fd);
+  close(poller);
+}
+
+void ScoringServer::collect(std::vector<Request>& batch, int64_t& wait) {
+  const int64_t maxDelay = std::chrono::nanoseconds(options_.maxDelay).count();
+  Request next;
+  while (batch.size() < options_.maxBatch && pending_.tryPop(next))
+    batch.push_back(std::move(next));
+  const size_t queued = batch.size();
+  if (wait == 0) {
+    // Probe with a short wait once requests start to queue up
+    wait = queued > 1 ? 1000 : 0;
+    return;
+  }
+
+  const int64_t deadline = std::min(batch.front().arrival + maxDelay, now() + wait);
+  while (batch.size() < options_.maxBatch) {
+    if (pending_.tryPop(next)) {
+      batch.push_back(std::move(next));
+    } else if (now() < deadline) {
+      std::this_thread::yield();
+    } else {
+      break;
+    }
+  }
+  // Waiting pays only while requests keep coming in during the wait; when all
+  // senders are already in the batch, e.g. clients waiting for their answer,
+  // it only adds latency
+  wait = batch.size() > queued ? std::min(maxDelay, 2 * wait) : wait / 2;
+}
+
+void ScoringServer::score(size_t scorer) {
+  std::vector<Request> batch;
+  Data rows;
+  int64_t wait = 0; // ns to wait for more requests, adapted per batch
+  while (true) {
+    Request first;
+    if (!pending_.pop(first, stopping_))
+      return;
+    batch.clear();
+    batch.push_back(std::move(first));
+    collect(batch, wait);
+
+    rows.resize(batch.size());
+    for (size_t i = 0; i < batch.size(); i++)
+      rows[i].swap(batch[i].row);
+    Predictions predictions;
+    {
+      const auto model = model_.read(scorer);
+      predictions = model->predict(rows);
+    }
+    for (size_t i = 0; i < batch.size(); i++) {
+      Response response{batch[i].connection, batch[i].seq, std::to_string(predictions.labels[i])};
+      if (!done_.push(response, stopping_))
+        return;
+    }
+    requests_ += batch.size();
+    batches_++;
+    const uint64_t one = 1;
+    if (write(wakeup_, &one, sizeof(one)) < 0) {
+      // The counter is saturated, so the socket thread is woken already
+    }
+  }
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "StreamingPredictor.hpp"
+
+StreamingPredictor::StreamingPredictor(const Predictor& predictor, const MetaData& meta, size_t chunkRows) :
+    StreamingPredictor([&predictor](const Data& rows) { return predictor.predict(rows); }, meta, chunkRows) {}
+
+StreamingPredictor::StreamingPredictor(Scorer scorer, const MetaData& meta, size_t chunkRows) :
+    scorer_(std::move(scorer)), meta_(meta), chunkRows_(std::max<size_t>(chunkRows, 1)) {}
+
+size_t StreamingPredictor::run(const std::string& input, std::ostream& output, bool probabilities) const {
+  RowStream stream(input, meta_);
+
+  // Two buffers: the reader fills one while the other is scored
+  Data buffers[2];
+  bool ready[2] = {false, false};
+  bool finished = false;
+  bool stopped = false; // the scoring side failed
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable changed;
+
+  std::thread reader([&]() {
+    try {
+      for (int i = 0; ; i ^= 1) {
+        {
+          std::unique_lock<std::mutex> lock(mutex);
+          changed.wait(lock, [&]() { return !ready[i] || stopped; });
+          if (stopped)
+            return;
+        }
+        const size_t n = stream.next(buffers[i], chunkRows_);
+        std::lock_guard<std::mutex> lock(mutex);
+        if (n == 0) {
+          finished = true;
+          changed.notify_all();
+          return;
+        }
+        ready[i] = true;
+        changed.notify_all();
+      }
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex);
+      error = std::current_exception();
+      finished = true;
+      changed.notify_all();
+    }
+  });
+
+  size_t total = 0;
+  std::string buffer;
+  for (int i = 0; ; i ^= 1) {
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      changed.wait(lock, [&]() { return ready[i] || finished; });
+      if (!ready[i])
+        break;
+    }
+    try {
+      write(scorer_(buffers[i]), output, probabilities, buffer);
+    } catch (...) {
+      // The reader may wait for this buffer; it is stopped before the
+      // error is passed on
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+        changed.notify_all();
+      }
+      reader.join();
+      throw;
+    }
+    total += buffers[i].size();
+    std::lock_guard<std::mutex> lock(mutex);
+    ready[i] = false;
+    changed.notify_all();
+  }
+  reader.join();
+  if (error)
+    std::rethrow_exception(error);
+  output.flush();
+  return total;
+}
+
+void StreamingPredictor::write(const Predictions& predictions, std::ostream& output, bool probabilities, std::string& buffer) const {
+  const auto names = meta_.dMapIS.find(meta_.labels.back());
+  buffer.clear();
+  for (size_t r = 0; r < predictions.size(); r++) {
+    const int label = predictions.labels[r];
+    if (names != std::end(meta_.dMapIS) && names->second.count(label))
+      buffer += names->second.at(label);
+    else
+      buffer += std::to_string(label);
+    if (probabilities) {
+      const double* p = predictions.probabilitiesOf(r);
+      for (size_t c = 0; c < predictions.numClasses; c++) {
+        buffer += ',';
+        buffer += std::to_string(p[c]);
+      }
+    }
+    buffer += '\n';
+  }
+  output.write(buffer.data(), buffer.size());
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include "Tree.hpp"
+
+namespace {
+
+void describe(const Tree& tree, const MetaData& meta, NodeId id, std::ostream& out) {
+  const Node& node = tree.node(id);
+  if (node.isLeaf()) {
+    const ClassCounter counts = tree.leaf(node).predictions();
+    out << "[";
+    for (const auto& [label, count]: std::map<int, int>(counts.begin(), counts.end()))
+      out << label << ":" << count << " ";
+    out << "]";
+    return;
+  }
+  out << node.question().toString(meta) << "(";
+  describe(tree, meta, node.trueBranch(), out);
+  describe(tree, meta, node.falseBranch(), out);
+  out << ")";
+}
+
+}
+
+NodeId Tree::addLeaf(const ClassCounter& counts) {
+  return nodes_.emplace(leaves_.emplace(counts));
+}
+
+NodeId Tree::addNode(NodeId trueBranch, NodeId falseBranch, const Question& question) {
+  return nodes_.emplace(trueBranch, falseBranch, question);
+}
+
+void Tree::computeProbabilities(const OutputLayout& layout, double smoothing) {
+  probabilities_ = LeafProbabilities(layout, smoothing);
+  for (Idx leaf = 0; leaf < leaves_.size(); leaf++)
+    probabilities_.add(leaves_[leaf].predictions());
+}
+
+void Tree::leafProbabilities(const Node& node, size_t numClasses, double* out) const {
+  std::fill(out, out + numClasses, 0.0);
+  if (probabilities_.empty()) {
+    const ClassCounter counts = leaf(node).predictions();
+    const double total = Utils::tree::mapValueSum(counts);
+    for (const auto& [label, count]: counts)
+      out[label] = count / total;
+    return;
+  }
+  if (probabilities_.numOutputs() != 1)
+    throw std::runtime_error("Tree predicts several outputs.");
+  const ProbabilityView probabilities = this->probabilities(node);
+  if (probabilities.size() != numClasses)
+    throw std::runtime_error("Tree predicts a different number of classes.");
+  std::copy(probabilities.begin(), probabilities.end(), out);
+}
+
+std::string Tree::toString(const MetaData& meta) const {
+  std::ostringstream out;
+  describe(*this, meta, root_, out);
+  return out.str();
+}
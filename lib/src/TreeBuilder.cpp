@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cmath>
+#include <future>
+#include <thread>
+#include "TreeBuilder.hpp"
+#include "Calculations.hpp"
+
+namespace {
+
+// Subtrees are handed to a new thread only near the root; deeper levels are
+// built by the thread that owns the parent, which keeps its scratch buffers
+// warm and avoids spawning a thread per node.
+int defaultParallelDepth() {
+  static const int depth = 1 + std::log2(std::max(1u, std::thread::hardware_concurrency()));
+  return depth;
+}
+
+}
+
+TreeBuilder::TreeBuilder(const ColumnStore& store, const TreeParams& params) :
+    store_(store), params_(params) {
+  if (params_.parallelDepth < 0)
+    params_.parallelDepth = defaultParallelDepth();
+}
+
+Tree TreeBuilder::build(VecIdx rows) const {
+  Tree tree;
+  TreeStats stats(store_.numFeatures());
+  tree.setRoot(buildTree(tree, stats, RowView{rows.data(), rows.data() + rows.size()}, 0, params_.seed));
+  tree.setStats(std::move(stats));
+  tree.computeProbabilities(store_.outputs(), params_.smoothing);
+  return tree;
+}
+
+NodeId TreeBuilder::buildTree(Tree& tree, TreeStats& stats, RowView rows, int depth, uint64_t seed) const {
+  double gain = 0;
+  Question question;
+  if (depth < params_.maxDepth && (int) rows.size() >= params_.minSamplesSplit && params_.extraTrees) {
+    std::tie(gain, question) = Calculations::find_random_split(store_, rows, seed, params_.maxFeatures);
+  } else if (depth < params_.maxDepth && (int) rows.size() >= params_.minSamplesSplit) {
+    const bool approximate = store_.hasSketches() && depth < params_.sketchDepth && (int) rows.size() >= params_.sketchMinRows;
+    if (params_.subsampleRows > 0 && (int) rows.size() > params_.subsampleRows) {
+      VecIdx sample;
+      Calculations::stratified_sample(store_, rows, params_.subsampleRows, seed, sample);
+      std::tie(gain, question) = Calculations::find_best_split(store_, RowView{sample.data(), sample.data() + sample.size()}, approximate);
+      if (gain > 0 && params_.refineThreshold)
+        std::tie(gain, question) = Calculations::refine_split(store_, rows, question);
+    } else {
+      std::tie(gain, question) = Calculations::find_best_split(store_, rows, approximate);
+    }
+  }
+  if(gain == 0){
+    ClassCounter clsCounter = Calculations::classCounts(store_, rows);
+    const NodeId leaf = tree.addLeaf(clsCounter);
+    stats.addNode(leaf, rows.size());
+    return leaf;
+  }
+  else {
+    auto [true_rows, false_rows] = Calculations::partition(store_, rows, question);
+    const uint64_t trueSeed = Utils::random::mix(seed, 1), falseSeed = Utils::random::mix(seed, 2);
+    NodeId trueBranch, falseBranch;
+    if (depth < params_.parallelDepth) {
+      // The other thread collects its statistics apart, merged once joined
+      TreeStats trueStats(store_.numFeatures());
+      auto retTrue = std::async(std::launch::async, &TreeBuilder::buildTree, this, std::ref(tree), std::ref(trueStats), true_rows, depth + 1, trueSeed);
+      falseBranch = buildTree(tree, stats, false_rows, depth + 1, falseSeed);
+      trueBranch = retTrue.get();
+      stats.merge(trueStats);
+    } else {
+      trueBranch = buildTree(tree, stats, true_rows, depth + 1, trueSeed);
+      falseBranch = buildTree(tree, stats, false_rows, depth + 1, falseSeed);
+    }
+    const NodeId node = tree.addNode(trueBranch, falseBranch, question);
+    stats.addSplit(question.column_, gain, rows.size());
+    stats.addNode(node, rows.size());
+    return node;
+  }
+}
@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "TreeStats.hpp"
+
+TreeStats::TreeStats(int numFeatures) :
+    impurityDecrease(numFeatures, 0.0), splitCount(numFeatures, 0), nodeSamples() {}
+
+void TreeStats::addSplit(int feature, double gain, Idx samples) {
+  impurityDecrease[feature] += gain * samples;
+  splitCount[feature]++;
+}
+
+void TreeStats::addNode(NodeId node, Idx samples) {
+  if (node >= nodeSamples.size())
+    nodeSamples.resize(node + 1, 0);
+  nodeSamples[node] = samples;
+}
+
+void TreeStats::merge(const TreeStats& other) {
+  for (size_t f = 0; f < other.impurityDecrease.size(); f++) {
+    impurityDecrease[f] += other.impurityDecrease[f];
+    splitCount[f] += other.splitCount[f];
+  }
+  // Every node is recorded by exactly one thread, the others hold zero
+  if (other.nodeSamples.size() > nodeSamples.size())
+    nodeSamples.resize(other.nodeSamples.size(), 0);
+  for (size_t n = 0; n < other.nodeSamples.size(); n++)
+    nodeSamples[n] += other.nodeSamples[n];
+}
+
+std::vector<double> TreeStats::importance() const {
+  std::vector<double> importance = impurityDecrease;
+  const double total = std::accumulate(importance.begin(), importance.end(), 0.0);
+  if (total > 0)
+    for (auto& value: importance)
+      value /= total;
+  return importance;
+}
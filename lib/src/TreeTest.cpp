@@ -6,23 +6,27 @@
 
 #include "TreeTest.hpp"
 
-using std::make_shared;
-using std::shared_ptr;
-
-TreeTest::TreeTest(const Data& testData, const MetaData& meta, const Node &root) {
-  test(testData, meta.labels, make_shared<Node>(root));
+TreeTest::TreeTest(const Data& testData, const MetaData& meta, const Tree &tree) {
+  test(testData, meta.labels, tree);
 }
 
-const ClassCounter TreeTest::classify(const VecI& row, shared_ptr<Node> node) const {
-  if (bool is_leaf = node->leaf() != nullptr; is_leaf) {
-    const auto &leaf = node->leaf();
-    return leaf->predictions();
+const Node& TreeTest::leafOf(const VecI& row, const Tree& tree) const {
+  const Node* node = &tree.node(tree.root());
+  while (!node->isLeaf()) {
+    if (node->question().solve(row))
+      node = &tree.node(node->trueBranch());
+    else
+      node = &tree.node(node->falseBranch());
   }
+  return *node;
+}
+
+const ClassCounter TreeTest::classify(const VecI& row, const Tree& tree) const {
+  return tree.leaf(leafOf(row, tree)).predictions();
+}
 
-  if (node->question().solve(row))
-    return classify(row, node->trueBranch());
-  else
-    return classify(row, node->falseBranch());
+ProbabilityView TreeTest::predictProba(const VecI& row, const Tree& tree, size_t output) const {
+  return tree.probabilities(leafOf(row, tree), output);
 }
 
 void TreeTest::printLeaf(ClassCounter counts, MetaData &meta) const {
@@ -35,14 +39,13 @@ void TreeTest::printLeaf(ClassCounter counts, MetaData &meta) const {
   Utils::print::print_map(scale, meta);
 }
 
-void TreeTest::test(const Data& testData, const VecS& labels, shared_ptr<Node> tree) const {
+void TreeTest::test(const Data& testData, const VecS& labels, const Tree& tree) const {
   float accuracy = 0;
   for (const auto& row: testData) {
-    const auto& classification = classify(row, tree);
-    static size_t last = row.size() - 1;
+    const size_t last = row.size() - 1;
     // Comment out this line to print the predicion of each example
-    // std::cout << "Actual: " << row[last] << "\tPrediction: "; printLeaf(classification);
-    if (Utils::tree::getMax(classification) == row[last])
+    // std::cout << "Actual: " << row[last] << "\tPrediction: "; printLeaf(classify(row, tree));
+    if (predictProba(row, tree).argmax() == row[last])
       accuracy += 1;
   }
   std::cout << "Total accuracy: " << (accuracy / testData.size()) << std::endl;
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "../lib/include/Bagging.hpp"
+#include "../lib/include/CodeGen.hpp"
+
+using boost::timer::cpu_timer;
+
+namespace {
+
+// Scores every test row `repeats` times and returns the wall time per row in ns
+template<typename F>
+double timePerRow(const Data& rows, int repeats, F&& predict, long& checksum) {
+  cpu_timer timer;
+  for (int i = 0; i < repeats; i++)
+    for (const auto& row: rows)
+      checksum += predict(row);
+  return static_cast<double>(timer.elapsed().wall) / (repeats * rows.size());
+}
+
+}
+
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  d.test.filename = argc > 2 ? argv[2] : "../data/covtype_test.arff";
+  const int ensembleSize = argc > 3 ? std::stoi(argv[3]) : 10;
+  const int repeats = argc > 4 ? std::stoi(argv[4]) : 10;
+
+  DataReader dr(d);
+  Bagging bc(dr, ensembleSize);
+  const Data& rows = dr.testData();
+
+  std::cout << "Compiling model." << std::endl; cpu_timer timer;
+  CompiledModel compiled = CompiledModel::compile(CodeGen(bc), "bagging_model");
+  std::cout << "Done. " << timer.format() << std::endl;
+
+  TreeTest t;
+  Predictor predictor(bc);
+  long checksum = 0;
+  const double interpreted = timePerRow(rows, repeats, [&](const VecI& row) {
+    VecI decisions;
+    for (const auto& learner: bc.learners())
+      decisions.push_back(Utils::tree::getMax(t.classify(row, learner.tree())));
+    return Utils::iterators::mostCommon(decisions.begin(), decisions.end());
+  }, checksum);
+  const double flattened = timePerRow(rows, repeats, [&](const VecI& row) {
+    return predictor.predict(row);
+  }, checksum);
+  const double generated = timePerRow(rows, repeats, [&](const VecI& row) {
+    return compiled.predict(row);
+  }, checksum);
+
+  size_t agree = 0;
+  for (const auto& row: rows)
+    agree += compiled.predict(row) == predictor.predict(row);
+
+  std::cout << "TreeTest::classify: " << interpreted << " ns/row" << std::endl;
+  std::cout << "Predictor:          " << flattened << " ns/row" << std::endl;
+  std::cout << "Generated code:     " << generated << " ns/row" << std::endl;
+  std::cout << "Agreement with Predictor: " << agree << "/" << rows.size() << " (checksum " << checksum << ")" << std::endl;
+  return 0;
+}
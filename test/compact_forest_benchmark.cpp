@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "../lib/include/Bagging.hpp"
+#include "../lib/include/CompactForest.hpp"
+
+using boost::timer::cpu_timer;
+
+namespace {
+
+// Approximate heap footprint of the arena-based trees, including the
+// unordered_map of every leaf
+size_t treeBytes(const Tree& tree) {
+  size_t total = tree.nodeCount() * sizeof(Node);
+  for (NodeId id = 0; id < tree.nodeCount(); id++) {
+    if (!tree.node(id).isLeaf())
+      continue;
+    const auto& counts = tree.leaf(tree.node(id)).predictions();
+    total += sizeof(Leaf) + counts.bucket_count() * sizeof(void*)
+      + counts.size() * (sizeof(ClassCounter::value_type) + 2 * sizeof(void*));
+  }
+  return total;
+}
+
+template<typename F>
+double rowsPerSecond(size_t rows, int repeats, F&& score) {
+  cpu_timer timer;
+  for (int i = 0; i < repeats; i++)
+    score();
+  return rows * repeats / (timer.elapsed().wall * 1e-9);
+}
+
+}
+
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  d.test.filename = argc > 2 ? argv[2] : "../data/covtype_test.arff";
+  const int ensembleSize = argc > 3 ? std::stoi(argv[3]) : 100;
+  const int repeats = argc > 4 ? std::stoi(argv[4]) : 5;
+
+  DataReader dr(d);
+  Bagging bc(dr, ensembleSize);
+  const Data& rows = dr.testData();
+
+  size_t arenaBytes = 0;
+  for (const auto& learner: bc.learners())
+    arenaBytes += treeBytes(learner.tree());
+  const Predictor predictor(bc);
+  const CompactForest compact16(bc, Predictor::Voting::Majority, 16);
+  const CompactForest compact8(bc, Predictor::Voting::Average, 8);
+
+  TreeTest t;
+  const double arenaSpeed = rowsPerSecond(rows.size(), repeats, [&]() {
+    for (const auto& row: rows)
+      for (const auto& learner: bc.learners())
+        t.classify(row, learner.tree());
+  });
+  const double predictorSpeed = rowsPerSecond(rows.size(), repeats, [&]() { predictor.predict(rows); });
+  const double compactSpeed = rowsPerSecond(rows.size(), repeats, [&]() { compact16.predict(rows); });
+
+  const Predictions reference = predictor.predict(rows);
+  const Predictions quantized = compact16.predict(rows);
+  size_t agree = 0;
+  for (size_t i = 0; i < rows.size(); i++)
+    agree += reference.labels[i] == quantized.labels[i];
+
+  std::cout << "Trees: " << bc.learners().size() << ", nodes: " << compact16.numNodes() << std::endl;
+  std::cout << "Arena trees:           " << arenaBytes << " bytes, " << arenaSpeed << " rows/s" << std::endl;
+  std::cout << "Predictor:             " << predictor.bytes() << " bytes, " << predictorSpeed << " rows/s" << std::endl;
+  std::cout << "CompactForest (16 bit): " << compact16.bytes() << " bytes, " << compactSpeed << " rows/s" << std::endl;
+  std::cout << "CompactForest (8 bit):  " << compact8.bytes() << " bytes" << std::endl;
+  std::cout << "Agreement with Predictor: " << agree << "/" << rows.size() << std::endl;
+  return 0;
+}
@@ -0,0 +1,21 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "../lib/include/CrossValidation.hpp"
+#include "../lib/include/DataReader.hpp"
+
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  d.test.filename = argc > 2 ? argv[2] : "../data/covtype_test.arff";
+  const int folds = argc > 3 ? std::stoi(argv[3]) : 5;
+
+  DataReader dr(d);
+  CrossValidation cv(dr.columns(), folds);
+  const auto grid = CrossValidation::grid({1, 10}, {4, 8, std::numeric_limits<int>::max()}, {2, 10});
+  CrossValidation::print(cv.run(grid), std::cout);
+  return 0;
+}
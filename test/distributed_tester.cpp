@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <sys/wait.h>
+#include <unistd.h>
+#include <strings.h>
+#include <fstream>
+#include "../lib/include/DataParallelBuilder.hpp"
+#include "../lib/include/DataReader.hpp"
+
+using boost::timer::cpu_timer;
+
+namespace {
+
+// Deals the data lines of an ARFF file round robin over shards that repeat its header
+std::vector<std::string> shard(const std::string& filename, int workers, const std::string& prefix) {
+  std::ifstream in(filename);
+  if (!in)
+    throw std::runtime_error("Can't open file: " + filename);
+  std::vector<std::string> names;
+  std::vector<std::ofstream> shards;
+  for (int w = 0; w < workers; w++) {
+    names.push_back(prefix + "." + std::to_string(w) + ".arff");
+    shards.emplace_back(names.back());
+  }
+  std::string line;
+  while (getline(in, line)) {
+    for (auto& out: shards)
+      out << line << "\n";
+    if (strncasecmp(line.c_str(), "@DATA", 5) == 0)
+      break;
+  }
+  for (size_t r = 0; getline(in, line); r++)
+    shards[r % workers] << line << "\n";
+  return names;
+}
+
+Tree train(const std::string& filename, Communicator& comm, const TreeParams& params, MetaData& meta) {
+  Dataset d;
+  d.train.filename = filename;
+  DataReader dr(d);
+  meta = dr.metaData();
+  return DataParallelBuilder(dr.columns(), comm, params).build();
+}
+
+}
+
+int main(int argc, char** argv) {
+  const std::string filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  const int workers = argc > 2 ? std::stoi(argv[2]) : 4;
+  const std::string transport = argc > 3 ? argv[3] : "unix";
+  TreeParams params;
+  params.maxDepth = argc > 4 ? std::stoi(argv[4]) : 10;
+
+  const std::string prefix = "/tmp/decisiontree-" + std::to_string(getpid());
+  const std::string address = transport == "tcp" ? "tcp:127.0.0.1:" + std::to_string(20000 + getpid() % 20000)
+                                                 : "unix:" + prefix;
+  const std::vector<std::string> shards = shard(filename, workers, prefix);
+
+  // The workers are forked before this process starts any thread; rank 0
+  // sends its tree back over a pipe
+  int channel[2];
+  if (pipe(channel) != 0)
+    throw std::runtime_error("Can't create pipe");
+  cpu_timer timer;
+  std::vector<pid_t> children;
+  for (int rank = 0; rank < workers; rank++) {
+    const pid_t pid = fork();
+    if (pid == 0) {
+      close(channel[0]);
+      try {
+        Communicator comm(rank, workers, address);
+        MetaData meta;
+        const Tree tree = train(shards[rank], comm, params, meta);
+        if (rank == 0) {
+          const std::string description = tree.toString(meta);
+          if (write(channel[1], description.data(), description.size()) != (ssize_t) description.size())
+            _exit(1);
+        }
+      } catch (const std::exception& e) {
+        std::cerr << "Worker " << rank << ": " << e.what() << std::endl;
+        _exit(1);
+      }
+      _exit(0);
+    }
+    children.push_back(pid);
+  }
+  close(channel[1]);
+  std::string distributed;
+  char buffer[1 << 16];
+  for (ssize_t n; (n = read(channel[0], buffer, sizeof(buffer))) > 0; )
+    distributed.append(buffer, n);
+  close(channel[0]);
+  bool failed = false;
+  for (const pid_t pid: children) {
+    int status = 0;
+    waitpid(pid, &status, 0);
+    failed |= !WIFEXITED(status) || WEXITSTATUS(status) != 0;
+  }
+  const double distributedSeconds = timer.elapsed().wall / 1e9;
+  for (const auto& name: shards)
+    std::remove(name.c_str());
+  if (failed) {
+    std::cerr << "A worker failed." << std::endl;
+    return 1;
+  }
+
+  timer.start();
+  Communicator single;
+  MetaData meta;
+  const Tree tree = train(filename, single, params, meta);
+  const double singleSeconds = timer.elapsed().wall / 1e9;
+  const bool identical = tree.toString(meta) == distributed;
+  std::cout << workers << " workers over " << transport << " sockets: " << distributedSeconds << " s, "
+            << "single process: " << singleSeconds << " s, " << tree.nodeCount() << " nodes, "
+            << (identical ? "identical trees" : "TREES DIFFER") << std::endl;
+  return identical ? 0 : 1;
+}
@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "../lib/include/Bagging.hpp"
+
+using boost::timer::cpu_timer;
+
+namespace {
+
+// Scores every test row `repeats` times and returns the wall time per row in ns
+template<typename F>
+double timePerRow(const Data& rows, int repeats, F&& predict, long& checksum) {
+  cpu_timer timer;
+  for (int i = 0; i < repeats; i++)
+    for (const auto& row: rows)
+      checksum += predict(row);
+  return static_cast<double>(timer.elapsed().wall) / (repeats * rows.size());
+}
+
+}
+
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  d.test.filename = argc > 2 ? argv[2] : "../data/covtype_test.arff";
+  const int ensembleSize = argc > 3 ? std::stoi(argv[3]) : 50;
+  const int repeats = argc > 4 ? std::stoi(argv[4]) : 10;
+
+  DataReader dr(d);
+  Bagging bc(dr, ensembleSize);
+  // Bootstrapped trees have seen most training rows, so they are ranked on
+  // the first quarter of the test rows, which is not timed
+  const Data& test = dr.testData();
+  const auto split = test.begin() + test.size() / 4;
+  const Data held(test.begin(), split);
+  const Data rows(split, test.end());
+
+  const Predictor full(bc);
+  const Predictor ordered = full.reordered(full.rankTrees(held));
+  long checksum = 0;
+  const double all = timePerRow(rows, repeats, [&](const VecI& row) {
+    return full.predict(row);
+  }, checksum);
+  std::cout << "All trees:         " << all << " ns/row" << std::endl;
+
+  for (const double confidence: {1.0, 0.99, 0.95}) {
+    Predictor::EarlyExit rule;
+    rule.confidence = confidence;
+    size_t used = 0, treesUsed = 0, agree = 0;
+    const double early = timePerRow(rows, repeats, [&](const VecI& row) {
+      const int label = ordered.predict(row, rule, &treesUsed);
+      used += treesUsed;
+      return label;
+    }, checksum);
+    for (const auto& row: rows)
+      agree += ordered.predict(row, rule) == full.predict(row);
+    std::cout << "Early exit (" << confidence << "): " << early << " ns/row, "
+              << static_cast<double>(used) / (repeats * rows.size()) << " of " << full.numTrees()
+              << " trees, agreement " << agree << "/" << rows.size() << std::endl;
+  }
+  std::cout << "(checksum " << checksum << ")" << std::endl;
+  return 0;
+}
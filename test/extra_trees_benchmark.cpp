@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "../lib/include/Bagging.hpp"
+
+using boost::timer::cpu_timer;
+
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  d.test.filename = argc > 2 ? argv[2] : "../data/covtype_test.arff";
+  const int ensembleSize = argc > 3 ? std::stoi(argv[3]) : 20;
+  TreeParams extra;
+  extra.extraTrees = true;
+  extra.maxFeatures = argc > 4 ? std::stoi(argv[4]) : 0;
+  extra.seed = 42;
+
+  DataReader dr(d);
+  cpu_timer timer;
+  const Bagging cart(dr, ensembleSize);
+  std::cout << "Bagged CART: " << timer.format();
+  cart.test();
+
+  timer.start();
+  const Bagging randomized(dr, ensembleSize, 1234, extra);
+  std::cout << "Extra-Trees: " << timer.format();
+  randomized.test();
+
+  // The same seed gives the same trees, whichever threads build them
+  extra.parallelDepth = 0;
+  const Bagging serial(dr, ensembleSize, 1234, extra);
+  const Predictions a = Predictor(randomized).predict(dr.testData());
+  const Predictions b = Predictor(serial).predict(dr.testData());
+  std::cout << "Reproducible: " << (a.probabilities == b.probabilities ? "yes" : "no") << std::endl;
+  return 0;
+}
@@ -0,0 +1,39 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "../lib/include/DataReader.hpp"
+#include "../lib/include/HoeffdingTree.hpp"
+#include "../lib/include/RowStream.hpp"
+
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  d.test.filename = argc > 2 ? argv[2] : "../data/covtype_test.arff";
+  const size_t batchSize = argc > 3 ? std::stoul(argv[3]) : 1000;
+
+  // Only the test file is loaded, for its metadata and rows; the training
+  // file is streamed into the learner in mini-batches
+  Dataset header = d;
+  header.train.filename = d.test.filename;
+  header.test.filename = "";
+  DataReader dr(header);
+  HoeffdingParams params;
+  params.gracePeriod = argc > 4 ? std::stoi(argv[4]) : 200;
+  HoeffdingTree ht(dr.metaData(), params);
+
+  boost::timer::cpu_timer timer;
+  RowStream stream(d.train.filename, dr.metaData());
+  Data batch;
+  while (stream.next(batch, batchSize) > 0)
+    ht.update(batch);
+  std::cout << "Learned from " << ht.rowsSeen() << " rows, " << ht.numLeaves() << " leaves. " << timer.format();
+  std::cout << "Update cost: " << static_cast<double>(timer.elapsed().wall) / ht.rowsSeen() << " ns/row" << std::endl;
+
+  if (ht.numLeaves() < 64)
+    ht.print();
+  ht.test(dr.trainData());
+  return 0;
+}
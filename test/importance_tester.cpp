@@ -0,0 +1,36 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <iomanip>
+#include "../lib/include/Bagging.hpp"
+#include "../lib/include/FeatureImportance.hpp"
+
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  d.test.filename = argc > 2 ? argv[2] : "../data/covtype_test.arff";
+  const int ensembleSize = argc > 3 ? std::stoi(argv[3]) : 5;
+
+  DataReader dr(d);
+  Bagging bc(dr, ensembleSize);
+  bc.test();
+
+  const TreeStats stats = bc.stats();
+  std::cout << "Split counts:\n";
+  for (size_t f = 0; f < stats.splitCount.size(); f++)
+    std::cout << std::setw(24) << std::left << dr.metaData().labels[f] << " " << stats.splitCount[f] << "\n";
+  std::cout << "Root samples of the first tree: "
+            << bc.learners().front().stats().nodeSamples[bc.learners().front().tree().root()] << "\n";
+
+  std::cout << "Impurity importance:\n";
+  FeatureImportance::print(bc.featureImportance(), dr.metaData(), std::cout);
+
+  boost::timer::cpu_timer timer;
+  const auto permutation = bc.permutationImportance(dr.testData());
+  std::cout << "Permutation importance: " << timer.format();
+  FeatureImportance::print(permutation, dr.metaData(), std::cout);
+  return 0;
+}
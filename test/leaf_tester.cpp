@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <cmath>
+#include <sstream>
+#include "../lib/include/CodeGen.hpp"
+#include "../lib/include/CompactForest.hpp"
+#include "../lib/include/DataReader.hpp"
+#include "../lib/include/DecisionTree.hpp"
+#include "../lib/include/Predictor.hpp"
+#include "../lib/include/TreeBuilder.hpp"
+#include "../lib/include/TreeTest.hpp"
+
+// Moves attribute `output` next to the class, so that both are predicted
+void moveToOutputs(const Data& data, size_t output, std::vector<VecI>& columns) {
+  const size_t last = data.front().size() - 1;
+  columns.assign(last + 1, VecI());
+  for (const auto& row: data) {
+    size_t c = 0;
+    for (size_t f = 0; f < last; f++)
+      if (f != output)
+        columns[c++].push_back(row[f]);
+    columns[c++].push_back(row[output]);
+    columns[c].push_back(row[last]);
+  }
+}
+
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/tennis.arff";
+  d.test.filename = argc > 2 ? argv[2] : "../data/tennis_test.arff";
+  const size_t output = argc > 3 ? std::stoul(argv[3]) : 3;
+  TreeParams params;
+  params.smoothing = argc > 4 ? std::stod(argv[4]) : 1.0;
+  DataReader dr(d);
+
+  MetaData meta = dr.metaData();
+  const size_t last = meta.labels.size() - 1;
+  std::rotate(meta.labels.begin() + output, meta.labels.begin() + output + 1, meta.labels.begin() + last);
+  std::rotate(meta.types.begin() + output, meta.types.begin() + output + 1, meta.types.begin() + last);
+  std::vector<VecI> columns, testColumns;
+  moveToOutputs(dr.trainData(), output, columns);
+  moveToOutputs(dr.testData(), output, testColumns);
+  const ColumnStore store(meta, std::move(columns), 2);
+  std::cout << "Outputs " << meta.labels[last - 1] << " and " << meta.labels[last]
+            << ", " << store.numClasses() << " joint classes" << std::endl;
+
+  VecIdx rows(store.numRows());
+  std::iota(rows.begin(), rows.end(), 0);
+  const Tree tree = TreeBuilder(store, params).build(std::move(rows));
+  const TreeTest tester;
+  const Predictor predictor({&tree}, store.numClasses(), Predictor::Voting::Average);
+  std::vector<double> correct(2, 0.0);
+  const size_t numTest = testColumns.front().size();
+  for (size_t r = 0; r < numTest; r++) {
+    VecI row;
+    for (const auto& column: testColumns)
+      row.push_back(column[r]);
+    for (size_t o = 0; o < 2; o++) {
+      const ProbabilityView probabilities = tester.predictProba(row, tree, o);
+      const ProbabilityView flat = predictor.leafProbabilities(row, 0, o);
+      if (!std::equal(probabilities.begin(), probabilities.end(), flat.begin(), flat.end()))
+        std::cout << "Predictor and tree disagree on row " << r << std::endl;
+      correct[o] += probabilities.argmax() == row[last - 1 + o];
+      std::cout << (o == 0 ? "Row " + std::to_string(r) + ": " : "  ");
+      for (const double p: probabilities)
+        std::cout << p << " ";
+    }
+    std::cout << std::endl;
+  }
+  for (size_t o = 0; o < 2; o++)
+    std::cout << "Accuracy on " << meta.labels[last - 1 + o] << ": " << correct[o] / numTest << std::endl;
+
+  // The exporters score a tree with several outputs not at all
+  bool rejected = true;
+  try {
+    std::ostringstream source;
+    CodeGen({&tree}, store.numClasses(), Predictor::Voting::Average).write(source);
+    rejected = false;
+  } catch (const std::runtime_error&) {}
+  try {
+    CompactForest({&tree}, store.numClasses(), Predictor::Voting::Average, 16);
+    rejected = false;
+  } catch (const std::runtime_error&) {}
+  std::cout << (rejected ? "Exporters reject" : "Exporters accept") << " trees with several outputs" << std::endl;
+
+  // and a single-output tree with the smoothed probabilities of Predictor
+  std::vector<size_t> samples(dr.trainData().size());
+  std::iota(samples.begin(), samples.end(), 0);
+  const DecisionTree single(dr, samples, params);
+  const Predictor reference({&single.tree()}, single.numClasses(), Predictor::Voting::Average);
+  const CompiledModel compiled = CompiledModel::compile(CodeGen(single), "leaf_model");
+  const CompactForest compact(single, 16);
+  const size_t C = compact.numClasses();
+  std::vector<double> expected(C), generated(C), quantized(C);
+  size_t mismatches = 0;
+  for (const auto& row: dr.testData()) {
+    reference.predictProba(row, expected.data());
+    compiled.predictProba(row, generated.data());
+    compact.predictProba(row, quantized.data());
+    for (size_t c = 0; c < C; c++)
+      mismatches += expected[c] != generated[c] || std::abs(expected[c] - quantized[c]) > 1.0 / 65535;
+  }
+  std::cout << "Exporters " << (mismatches == 0 ? "match" : "differ from") << " Predictor with smoothing "
+            << params.smoothing << std::endl;
+  return rejected && mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "../lib/include/DecisionTree.hpp"
+#include "../lib/include/Numa.hpp"
+
+// Run under numactl, e.g. `numactl --cpunodebind=0 ./NumaTest`, or set
+// DECISIONTREE_NUMA_NODES to shard over simulated nodes on a single node.
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  d.test.filename = argc > 2 ? argv[2] : "../data/covtype_test.arff";
+
+  std::cout << "libnuma: " << (Numa::available() ? "yes" : "no") << ", nodes: " << Numa::numNodes() << std::endl;
+  for (int node = 0; node < Numa::numNodes(); node++)
+    std::cout << "  node " << node << ": " << Numa::numCpus(node) << " cpus" << std::endl;
+
+  DataReader dr(d);
+  const ColumnStore& store = dr.columns();
+  std::cout << "Column placement (owner / page node):" << std::endl;
+  for (int f = 0; f < store.numFeatures(); f++)
+    std::cout << "  " << dr.metaData().labels[f] << ": " << store.columnNode(f) << " / "
+              << Numa::nodeOfAddress(store.column(f).data()) << std::endl;
+
+  DecisionTree dt(dr);
+  dt.test();
+  return 0;
+}
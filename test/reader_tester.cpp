@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include "../lib/include/DecisionTree.hpp"
+#include "../lib/include/LibsvmReader.hpp"
+#include "../lib/include/Predictor.hpp"
+#include "../lib/include/TreeBuilder.hpp"
+
+int main(int argc, char** argv) {
+  // CSV, types and categories inferred from the header and values
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/play_tennis.csv";
+  d.test.filename = argc > 2 ? argv[2] : "../data/play_tennis_test.csv";
+  DecisionTree dt(d);
+  dt.print();
+  dt.test();
+
+  // LIBSVM, trained on the sparse layout without expanding it
+  const std::string train = argc > 3 ? argv[3] : "../data/iris.libsvm";
+  const std::string test = argc > 4 ? argv[4] : "../data/iris_test.libsvm";
+  boost::timer::cpu_timer timer;
+  const LibsvmReader reader;
+  const ColumnStore store = reader.read(train);
+  const ColumnStore testStore = reader.read(test, store.meta());
+  std::cout << "Read " << store.numRows() << " rows, " << store.numFeatures() << " features, "
+            << store.sparseRows().nonZeros() << " non-zeros. " << timer.format();
+
+  timer.start();
+  VecIdx rows(store.numRows());
+  std::iota(rows.begin(), rows.end(), 0);
+  const Tree tree = TreeBuilder(store).build(std::move(rows));
+  std::cout << "Built tree with " << tree.nodeCount() << " nodes. " << timer.format();
+
+  const Predictor predictor({&tree}, store.numClasses(), Predictor::Voting::Average);
+  double correct = 0;
+  for (Idx r = 0; r < testStore.numRows(); r++)
+    correct += predictor.predict(testStore, r) == testStore.labels()[r];
+  std::cout << "Total accuracy: " << correct / testStore.numRows() << std::endl;
+  return 0;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <iomanip>
+#include "../lib/include/TreeBuilder.hpp"
+
+using boost::timer::cpu_timer;
+
+namespace {
+
+void addColumn(MetaData& meta, std::vector<VecI>& columns, const std::string& label, VecI column) {
+  meta.labels.push_back(label);
+  meta.types.push_back("NUMERIC");
+  columns.push_back(std::move(column));
+}
+
+// Wide data set as left by one-hot encoding: groups of indicator columns of
+// which one is set per row, a few numeric columns, constant columns and
+// copies of other columns. The class depends on some of the indicators and
+// on the first numeric column.
+void generate(size_t n, int groups, int width, uint64_t seed, MetaData& meta, std::vector<VecI>& columns) {
+  Utils::random::SplitMix64 rng{seed};
+  std::vector<VecI> category(groups, VecI(n));
+  for (auto& group: category)
+    for (auto& value: group)
+      value = rng.below(width);
+  for (int g = 0; g < groups; g++)
+    for (int c = 0; c < width; c++) {
+      VecI column(n);
+      for (size_t r = 0; r < n; r++)
+        column[r] = category[g][r] == c ? 1 + (c % 3 == 0 ? rng.below(4) : 0) : 0;
+      addColumn(meta, columns, "g" + std::to_string(g) + "_" + std::to_string(c), std::move(column));
+    }
+  for (int i = 0; i < 4; i++) {
+    VecI column(n);
+    for (auto& value: column)
+      value = (int) rng.below(1000) - 500;
+    addColumn(meta, columns, "x" + std::to_string(i), std::move(column));
+  }
+  addColumn(meta, columns, "zero", VecI(n, 0));
+  addColumn(meta, columns, "seven", VecI(n, 7));
+  addColumn(meta, columns, "x0_copy", VecI(columns[groups * width]));
+  addColumn(meta, columns, "g0_1_copy", VecI(columns[1]));
+
+  VecI labels(n);
+  for (size_t r = 0; r < n; r++) {
+    const int score = (category[0][r] % 4) + (category[1][r] < width / 3 ? 2 : 0)
+                      + (columns[groups * width][r] > 100 ? 1 : 0) + (rng.below(10) == 0 ? 1 : 0);
+    labels[r] = score % 3;
+  }
+  meta.labels.push_back("class");
+  meta.types.push_back("CATEGORICAL");
+  meta.dMapIS["class"] = {{0, "a"}, {1, "b"}, {2, "c"}};
+  columns.push_back(std::move(labels));
+}
+
+}
+
+// Learns a tree on a wide synthetic data set with and without feature
+// reduction, checks that both trees are the same and compares their times.
+int main(int argc, char** argv) {
+  const size_t n = argc > 1 ? std::stoul(argv[1]) : 100000;
+  const int groups = argc > 2 ? std::stoi(argv[2]) : 20;
+  const int width = argc > 3 ? std::stoi(argv[3]) : 50;
+  TreeParams params;
+  params.maxDepth = argc > 4 ? std::stoi(argv[4]) : 12;
+
+  MetaData meta;
+  std::vector<VecI> columns;
+  generate(n, groups, width, 42, meta, columns);
+  VecIdx rows(n);
+  std::iota(rows.begin(), rows.end(), 0);
+
+  cpu_timer timer;
+  const ColumnStore plain(meta, columns);
+  const Tree expected = TreeBuilder(plain, params).build(rows);
+  std::cout << "All " << plain.numFeatures() << " features: " << timer.format();
+
+  timer.start();
+  ColumnStore reduced(meta, std::move(columns));
+  reduced.reduceFeatures();
+  std::cout << "Reduced in " << timer.format();
+  size_t bundled = 0;
+  for (size_t b = 0; b < reduced.numBundles(); b++)
+    bundled += reduced.bundle(b).members.size();
+  size_t redundant = 0;
+  for (int f = 0; f < reduced.numFeatures(); f++)
+    redundant += reduced.isRedundant(f);
+  std::cout << redundant << " redundant features, " << bundled << " features in " << reduced.numBundles()
+            << " bundles, " << reduced.features().size() << " scanned alone" << std::endl;
+
+  timer.start();
+  const Tree tree = TreeBuilder(reduced, params).build(rows);
+  std::cout << "Reduced features: " << timer.format();
+
+  const bool same = tree.toString(meta) == expected.toString(meta);
+  std::cout << "Root question: " << tree.node(tree.root()).question().toString(meta) << "\n";
+  std::cout << "Features used, by impurity importance:\n";
+  const std::vector<double> importance = tree.stats().importance();
+  VecIdx used;
+  for (size_t f = 0; f < importance.size(); f++)
+    if (importance[f] > 0)
+      used.push_back(f);
+  std::stable_sort(used.begin(), used.end(), [&](Idx a, Idx b) { return importance[a] > importance[b]; });
+  for (const Idx f: used)
+    std::cout << std::setw(24) << std::left << meta.labels[f] << " " << importance[f] << "\n";
+  std::cout << (same ? "Trees are identical." : "Trees differ!") << std::endl;
+  return same ? 0 : 1;
+}
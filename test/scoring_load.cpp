@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <deque>
+#include <thread>
+#include "../lib/include/DataReader.hpp"
+
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct ClientResult {
+  std::vector<double> latencies = {}; // in microseconds
+  size_t errors = 0;
+  std::string failure = {};
+};
+
+int connectTo(const std::string& path) {
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0 || connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+    throw std::runtime_error("Can't connect to " + path + ": " + std::strerror(errno));
+  return fd;
+}
+
+// Keeps depth requests in flight on one connection, cycling through lines
+void client(const std::string& path, const VecS& lines, size_t offset, size_t requests, size_t depth, ClientResult& result) {
+  try {
+    const int fd = connectTo(path);
+    std::deque<Clock::time_point> sent;
+    std::string input;
+    char buffer[1 << 12];
+    size_t issued = 0, answered = 0;
+    while (answered < requests) {
+      while (issued < requests && sent.size() < depth) {
+        const std::string& line = lines[(offset + issued++) % lines.size()];
+        sent.push_back(Clock::now());
+        if (write(fd, line.data(), line.size()) != (ssize_t) line.size())
+          throw std::runtime_error("Can't send request");
+      }
+      const ssize_t n = read(fd, buffer, sizeof(buffer));
+      if (n <= 0)
+        throw std::runtime_error("Connection closed by server");
+      input.append(buffer, n);
+      size_t begin = 0;
+      for (size_t end; (end = input.find('\n', begin)) != std::string::npos; begin = end + 1) {
+        result.latencies.push_back(std::chrono::duration<double, std::micro>(Clock::now() - sent.front()).count());
+        sent.pop_front();
+        result.errors += input.compare(begin, 6, "error:") == 0;
+        answered++;
+      }
+      input.erase(0, begin);
+    }
+    close(fd);
+  } catch (const std::exception& e) {
+    result.failure = e.what();
+  }
+}
+
+double percentile(const std::vector<double>& sorted, double p) {
+  return sorted.empty() ? 0 : sorted[std::min(sorted.size() - 1, size_t(p * sorted.size()))];
+}
+
+}
+
+// Sends the rows of a data file to a scoring server from concurrent
+// connections and reports the latency percentiles and the throughput.
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype_test.arff";
+  const std::string socketPath = argc > 2 ? argv[2] : "/tmp/decisiontree.sock";
+  const size_t connections = argc > 3 ? std::stoul(argv[3]) : 8;
+  const size_t requests = argc > 4 ? std::stoul(argv[4]) : 20000;
+  const size_t depth = argc > 5 ? std::stoul(argv[5]) : 1;
+
+  const DataReader dr(d);
+  VecS lines;
+  for (const auto& row: dr.trainData()) {
+    std::string line;
+    for (const int value: row)
+      line += std::to_string(value) + ",";
+    line.back() = '\n';
+    lines.push_back(line);
+  }
+
+  std::vector<ClientResult> results(connections);
+  std::vector<std::thread> clients;
+  const auto start = Clock::now();
+  for (size_t c = 0; c < connections; c++)
+    clients.emplace_back(client, std::cref(socketPath), std::cref(lines), c * requests, requests, depth, std::ref(results[c]));
+  for (auto& thread: clients)
+    thread.join();
+  const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+  std::vector<double> latencies;
+  size_t errors = 0;
+  for (const auto& result: results) {
+    if (!result.failure.empty()) {
+      std::cerr << "Client failed: " << result.failure << std::endl;
+      return 1;
+    }
+    latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+    errors += result.errors;
+  }
+  std::sort(latencies.begin(), latencies.end());
+  std::cout << connections << " connections, " << depth << " in flight each: "
+            << latencies.size() / seconds << " requests/s, latency p50 " << percentile(latencies, 0.5)
+            << " us, p99 " << percentile(latencies, 0.99) << " us, " << errors << " errors" << std::endl;
+  return errors == 0 ? 0 : 1;
+}
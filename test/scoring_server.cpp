@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <signal.h>
+#include <thread>
+#include "../lib/include/Bagging.hpp"
+#include "../lib/include/ScoringServer.hpp"
+
+using boost::timer::cpu_timer;
+
+namespace {
+
+std::unique_ptr<const Predictor> train(const DataReader& dr, int trees, uint seed) {
+  cpu_timer timer;
+  const Bagging bagging(dr, trees, seed);
+  std::cout << "Trained " << trees << " trees with seed " << seed << ". " << timer.format() << std::flush;
+  return std::make_unique<const Predictor>(bagging, Predictor::Voting::Average);
+}
+
+}
+
+// Serves a bagged ensemble trained on a file; SIGHUP trains a new ensemble
+// on it and swaps it in, SIGINT or SIGTERM stops the server.
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  const std::string socketPath = argc > 2 ? argv[2] : "/tmp/decisiontree.sock";
+  const int trees = argc > 3 ? std::stoi(argv[3]) : 16;
+  ScoringOptions options;
+  options.scorers = argc > 4 ? std::stoul(argv[4]) : 1;
+  options.maxBatch = argc > 5 ? std::stoul(argv[5]) : 256;
+  options.maxDelay = std::chrono::microseconds(argc > 6 ? std::stol(argv[6]) : 500);
+
+  // Signals are taken by this thread only, with sigwait
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGHUP);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  const DataReader dr(d);
+  uint seed = 1234;
+  ScoringServer server(socketPath, dr.columns().numFeatures(), train(dr, trees, seed), options);
+  std::thread serving(&ScoringServer::run, &server);
+  std::cout << "Listening on " << socketPath << std::endl;
+
+  for (int signal = 0; sigwait(&signals, &signal) == 0 && signal == SIGHUP; ) {
+    server.publish(train(dr, trees, ++seed));
+    std::cout << "Serving model version " << server.version() << std::endl;
+  }
+  server.stop();
+  serving.join();
+  std::cout << server.requests() << " requests in " << server.batches() << " batches" << std::endl;
+  return 0;
+}
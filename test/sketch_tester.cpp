@@ -0,0 +1,35 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <numeric>
+#include "../lib/include/DecisionTree.hpp"
+
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  d.test.filename = argc > 2 ? argv[2] : "../data/covtype_test.arff";
+  d.sketchEpsilon = argc > 3 ? std::stod(argv[3]) : 0.01;
+  TreeParams approximate;
+  approximate.sketchDepth = argc > 4 ? std::stoi(argv[4]) : 4;
+  approximate.sketchMinRows = argc > 5 ? std::stoi(argv[5]) : 1 << 14;
+
+  DataReader dr(d);
+  const ColumnStore& store = dr.columns();
+  std::cout << "Sketches (values / gap):" << std::endl;
+  for (int f = 0; f < store.numFeatures(); f++)
+    if (store.isNumeric(f) && !store.isSparse(f))
+      std::cout << "  " << dr.metaData().labels[f] << ": " << store.sketch(f).size() << " / " << store.sketch(f).gap() << std::endl;
+
+  std::vector<size_t> samples(dr.trainData().size());
+  std::iota(samples.begin(), samples.end(), 0);
+  std::cout << "Exact split search:" << std::endl;
+  DecisionTree exact(dr, samples, TreeParams());
+  exact.test();
+  std::cout << "Sketch split search up to depth " << approximate.sketchDepth << ":" << std::endl;
+  DecisionTree sketched(dr, samples, approximate);
+  sketched.test();
+  return 0;
+}
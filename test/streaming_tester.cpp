@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <fstream>
+#include "../lib/include/Bagging.hpp"
+#include "../lib/include/StreamingPredictor.hpp"
+
+int main(int argc, char** argv) {
+  Dataset d;
+  d.train.filename = argc > 1 ? argv[1] : "../data/covtype.arff";
+  const std::string input = argc > 2 ? argv[2] : "../data/covtype_test.arff";
+  const std::string output = argc > 3 ? argv[3] : "predictions.csv";
+
+  DataReader dr(d);
+  Bagging bc(dr, 5);
+  Predictor predictor(bc);
+
+  std::ofstream out(output);
+  std::cout << "Start scoring " << input << "." << std::endl; boost::timer::cpu_timer timer;
+  const size_t rows = StreamingPredictor(predictor, dr.metaData(), 4096).run(input, out, true);
+  std::cout << "Done. " << rows << " rows. " << timer.format() << std::endl;
+  return 0;
+}
@@ -0,0 +1,77 @@
+/*
+ * Copyright (c) DTAI - KU Leuven – All rights reserved.
+ * Proprietary, do not copy or distribute without permission. 
+ * Written by Pieter Robberechts, 2019
+ */
+
+#include <iomanip>
+#include <random>
+#include "../lib/include/Predictor.hpp"
+#include "../lib/include/TreeBuilder.hpp"
+
+using boost::timer::cpu_timer;
+
+namespace {
+
+// Numeric features, half uniform and half skewed, and three classes given by
+// thresholds on a few of them, with 10% label noise
+ColumnStore synthetic(size_t rows, int features, uint seed) {
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> uniform(0, 100000);
+  std::exponential_distribution<double> skewed(1e-3);
+  std::uniform_real_distribution<double> noise(0, 1);
+  MetaData meta;
+  for (int f = 0; f < features; f++) {
+    meta.labels.push_back("x" + std::to_string(f));
+    meta.types.push_back("NUMERIC");
+  }
+  meta.labels.push_back("class");
+  meta.types.push_back("CATEGORICAL");
+  for (int c = 0; c < 3; c++)
+    meta.dMapIS["class"][c] = std::string(1, 'a' + c);
+
+  std::vector<VecI> columns(features + 1, VecI(rows));
+  for (size_t r = 0; r < rows; r++) {
+    for (int f = 0; f < features; f++)
+      columns[f][r] = f % 2 == 0 ? uniform(rng) : static_cast<int>(skewed(rng));
+    int label = (columns[0][r] > 37000) + (columns[2][r] + columns[1][r] > 60000) + (columns[3][r] < 700);
+    if (noise(rng) < 0.1)
+      label = rng() % 3;
+    columns[features][r] = std::min(label, 2);
+  }
+  return ColumnStore(meta, std::move(columns));
+}
+
+}
+
+int main(int argc, char** argv) {
+  const size_t rows = argc > 1 ? std::stoul(argv[1]) : 1000000;
+  const int features = argc > 2 ? std::stoi(argv[2]) : 8;
+  const int maxDepth = argc > 3 ? std::stoi(argv[3]) : 10;
+  const ColumnStore train = synthetic(rows, features, 1);
+  const ColumnStore test = synthetic(rows / 5, features, 2);
+
+  std::cout << "Sample size   refine   time (s)   accuracy" << std::endl;
+  for (const int sample: {0, 100000, 20000, 5000}) {
+    for (const bool refine: {false, true}) {
+      if (sample == 0 && refine)
+        continue;
+      TreeParams params;
+      params.maxDepth = maxDepth;
+      params.subsampleRows = sample;
+      params.refineThreshold = refine;
+      VecIdx all(train.numRows());
+      std::iota(all.begin(), all.end(), 0);
+      cpu_timer timer;
+      const Tree tree = TreeBuilder(train, params).build(std::move(all));
+      const double seconds = timer.elapsed().wall / 1e9;
+      const Predictor predictor({&tree}, train.numClasses(), Predictor::Voting::Average);
+      double correct = 0;
+      for (Idx r = 0; r < test.numRows(); r++)
+        correct += predictor.predict(test, r) == test.labels()[r];
+      std::cout << std::setw(11) << (sample == 0 ? "all" : std::to_string(sample)) << std::setw(9) << (refine ? "yes" : "no")
+                << std::setw(11) << seconds << std::setw(11) << correct / test.numRows() << std::endl;
+    }
+  }
+  return 0;
+}